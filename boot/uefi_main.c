@@ -4,7 +4,10 @@
 
 #define KERNEL_LOAD_ADDRESS 0x100000
 
-typedef void (*kernel_entry_t)(EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE *);
+// Userspace heap beyond the back buffer, for caches and scratch
+#define USERSPACE_HEAP_RESERVE (24 * 1024 * 1024)
+
+typedef void (*kernel_entry_t)(EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE *, UINT64, UINT64);
 
 EFI_STATUS EFIAPI efi_main(EFI_HANDLE ImageHandle, EFI_SYSTEM_TABLE *SystemTable) {
     EFI_STATUS status;
@@ -61,7 +64,7 @@ EFI_STATUS EFIAPI efi_main(EFI_HANDLE ImageHandle, EFI_SYSTEM_TABLE *SystemTable
     }
     
     // Copy kernel code
-    extern void kernel_main(EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE *);
+    extern void kernel_main(EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE *, UINT64, UINT64);
     UINT8 *kernel_code = (UINT8 *)kernel_addr;
     UINT8 *kernel_func = (UINT8 *)kernel_main;
     
@@ -70,6 +73,26 @@ EFI_STATUS EFIAPI efi_main(EFI_HANDLE ImageHandle, EFI_SYSTEM_TABLE *SystemTable
         kernel_code[i] = kernel_func[i];
     }
     
+    // Userspace heap, sized for a back buffer of the current mode. Without
+    // it userspace falls back to its built-in heap.
+    EFI_PHYSICAL_ADDRESS heap_addr = 0;
+    UINTN heap_size = (UINTN)gop->Mode->Info->HorizontalResolution *
+                      gop->Mode->Info->VerticalResolution * 4 + USERSPACE_HEAP_RESERVE;
+    
+    status = uefi_call_wrapper(
+        BS->AllocatePages,
+        4,
+        AllocateAnyPages,
+        EfiLoaderData,
+        EFI_SIZE_TO_PAGES(heap_size),
+        &heap_addr
+    );
+    
+    if (EFI_ERROR(status)) {
+        heap_addr = 0;
+        heap_size = 0;
+    }
+    
     // Get memory map
     UINTN map_key;
     UINTN map_size = 0;
@@ -127,7 +150,7 @@ EFI_STATUS EFIAPI efi_main(EFI_HANDLE ImageHandle, EFI_SYSTEM_TABLE *SystemTable
     // PHASE 3: Jump to kernel (C++ userspace)
     // ========================================
     kernel_entry_t kernel_entry = (kernel_entry_t)kernel_addr;
-    kernel_entry(gop->Mode);
+    kernel_entry(gop->Mode, heap_addr, heap_size);
     
     while(1);
     return EFI_SUCCESS;
@@ -0,0 +1,43 @@
+#ifndef AA_COVERAGE_H
+#define AA_COVERAGE_H
+
+#include <stdint.h>
+
+// Anti-aliased edge coverage for curved shapes, shared by the boot UI and
+// the userspace renderer. Plain C with no dependencies, so both the UEFI
+// loader and kernel.bin link the same object.
+//
+// Radii are fixed point in AA_SUBPIXEL units. Pixel offsets are whole
+// pixels from the center pixel. Coverage is 0..255, the fraction of a
+// pixel inside the shape.
+
+#define AA_SUBPIXEL 16
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Coverage of a disc for pixels dx0 .. dx0 + count - 1 of row dy. feather
+// is the width of the edge ramp, AA_SUBPIXEL for a crisp one-pixel edge
+// and more for a soft falloff.
+void aa_disc_span(uint8_t *coverage, int32_t dx0, int32_t dy, int32_t count,
+                  int32_t radius, int32_t feather);
+
+// As aa_disc_span, but with the first pixel center's offset from the disc
+// center in AA_SUBPIXEL units, for centers that fall between pixels
+void aa_disc_span_subpixel(uint8_t *coverage, int32_t dx0, int32_t dy, int32_t count,
+                           int32_t radius, int32_t feather);
+
+// Coverage of a pixel whose center is distance inside a straight edge, in
+// AA_SUBPIXEL units; negative distances are outside
+uint8_t aa_edge_coverage(int32_t distance);
+
+// Coverage of the annulus between inner and outer radius, same layout
+void aa_ring_span(uint8_t *coverage, int32_t dx0, int32_t dy, int32_t count,
+                  int32_t inner, int32_t outer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AA_COVERAGE_H
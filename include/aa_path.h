@@ -0,0 +1,77 @@
+#ifndef AA_PATH_H
+#define AA_PATH_H
+
+#include <stdint.h>
+
+// Vector paths shared by the boot UI and the userspace renderer. Contours
+// of lines, quadratic curves and circular arcs are flattened to line
+// segments as they are added, then filled with a signed-area accumulation
+// buffer: each segment adds the exact area it sweeps to the pixels it
+// crosses, and one pass of running sums per row turns that into coverage.
+// Cost is the path's perimeter plus its area, with no roots or angles per
+// pixel.
+//
+// Coordinates are 24.8 fixed point with pixel corners at whole numbers.
+// Angles are AA_ANGLE_TURN units per turn, zero along +x and growing
+// clockwise on screen. Fills use the non-zero rule.
+
+#define AA_PATH_SHIFT 8
+#define AA_PATH_ONE (1 << AA_PATH_SHIFT)
+#define AA_ANGLE_TURN 65536
+
+typedef struct {
+    int32_t x0, y0, x1, y1;
+} aa_line_t;
+
+typedef struct {
+    aa_line_t *lines;         // Caller's storage
+    int32_t count;
+    int32_t capacity;
+    int32_t overflow;         // Segments were dropped for lack of room
+    int32_t open;             // A contour is in progress
+    int32_t start_x, start_y; // First point of the open contour
+    int32_t x, y;             // Pen
+    int32_t min_x, min_y, max_x, max_y;
+} aa_path_t;
+
+// Receives coverage for pixels x .. x + count - 1 of row y; runs with no
+// coverage are skipped
+typedef void (*aa_span_fn)(void *ctx, int32_t x, int32_t y, const uint8_t *coverage,
+                           int32_t count);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void aa_path_init(aa_path_t *path, aa_line_t *lines, int32_t capacity);
+void aa_path_reset(aa_path_t *path);
+
+// Starting a contour closes the one before it
+void aa_path_move_to(aa_path_t *path, int32_t x, int32_t y);
+void aa_path_line_to(aa_path_t *path, int32_t x, int32_t y);
+void aa_path_quad_to(aa_path_t *path, int32_t cx, int32_t cy, int32_t x, int32_t y);
+void aa_path_close(aa_path_t *path);
+
+// Circular arc around cx, cy from angle start through sweep; negative
+// sweeps run counterclockwise. Continues the open contour with a line to
+// the arc's first point, or starts a new contour there.
+void aa_path_arc(aa_path_t *path, int32_t cx, int32_t cy, int32_t radius,
+                 int32_t start, int32_t sweep);
+
+// Pixel rect holding every point of the path; zero size when empty
+void aa_path_bounds(const aa_path_t *path, int32_t *x, int32_t *y, int32_t *w, int32_t *h);
+
+// Fill the path inside the pixel rect x, y, w, h. accum is scratch for
+// accum_size entries, at least w + 2; rects taller than it holds rows
+// for are filled in bands.
+void aa_path_fill(const aa_path_t *path, int32_t x, int32_t y, int32_t w, int32_t h,
+                  int32_t *accum, int32_t accum_size, aa_span_fn emit, void *ctx);
+
+// cos and sin of angle, scaled by 2^30
+void aa_sincos(int32_t angle, int32_t *cos_out, int32_t *sin_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AA_PATH_H
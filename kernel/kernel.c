@@ -65,9 +65,23 @@ static uint8_t shift_pressed = 0;
 static uint64_t g_tick_count = 0;
 static int last_key_returned = -999;  // Track what we returned
 
+// FPU/SSE state. The userspace pixel kernels use SSE2/AVX2, which fault
+// with #UD until CR0/CR4 say the OS saves that state.
+static uint8_t g_sse_enabled = 0;
+static uint8_t g_avx_enabled = 0;
+
+static inline void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t *a,
+                         uint32_t *b, uint32_t *c, uint32_t *d) {
+    __asm__ volatile ("cpuid" : "=a"(*a), "=b"(*b), "=c"(*c), "=d"(*d)
+                      : "a"(leaf), "c"(subleaf));
+}
+
 // C++ entry point
 extern void userspace_main(uint32_t* framebuffer, uint32_t width,
-                          uint32_t height, uint32_t pitch);
+                          uint32_t height, uint32_t pitch,
+                          uint32_t pixel_format, uint32_t red_mask,
+                          uint32_t green_mask, uint32_t blue_mask,
+                          void* heap, uint64_t heap_size);
 
 // PS/2 Keyboard Initialization
 // Initializes the PS/2 keyboard controller after UEFI ExitBootServices()
@@ -120,7 +134,66 @@ void init_ps2_keyboard() {
     }
 }
 
-void kernel_main(gop_mode_t *gop_mode) {
+// FPU/SSE initialization
+// Turns on x87, SSE (FXSAVE/FXRSTOR, #XM for SIMD exceptions) and, when the
+// CPU supports XSAVE and AVX, the YMM state so AVX2 code can run
+void init_fpu_sse() {
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(1, 0, &eax, &ebx, &ecx, &edx);
+    
+    // FXSR (bit 24) and SSE2 (bit 26) are architectural on x86_64,
+    // but check anyway so a broken emulator falls back to scalar code
+    if (!(edx & (1u << 24)) || !(edx & (1u << 26))) return;
+    
+    uint64_t cr0;
+    __asm__ volatile ("mov %%cr0, %0" : "=r"(cr0));
+    cr0 &= ~(1ull << 2);  // EM: no x87 emulation
+    cr0 &= ~(1ull << 3);  // TS: no lazy-switch trap
+    cr0 |= (1ull << 1);   // MP: WAIT honors TS
+    cr0 |= (1ull << 5);   // NE: native x87 error reporting
+    __asm__ volatile ("mov %0, %%cr0" : : "r"(cr0));
+    
+    uint64_t cr4;
+    __asm__ volatile ("mov %%cr4, %0" : "=r"(cr4));
+    cr4 |= (1ull << 9);   // OSFXSR: FXSAVE/FXRSTOR and SSE enabled
+    cr4 |= (1ull << 10);  // OSXMMEXCPT: SIMD FP exceptions via #XM
+    
+    // XSAVE (bit 26) and AVX (bit 28): let the OS own YMM state
+    int avx = (ecx & (1u << 26)) && (ecx & (1u << 28));
+    if (avx) cr4 |= (1ull << 18);  // OSXSAVE
+    __asm__ volatile ("mov %0, %%cr4" : : "r"(cr4));
+    
+    if (avx) {
+        // XCR0: x87 | SSE | AVX
+        uint32_t xcr0_lo, xcr0_hi;
+        __asm__ volatile ("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+        xcr0_lo |= 0x7;
+        __asm__ volatile ("xsetbv" : : "a"(xcr0_lo), "d"(xcr0_hi), "c"(0));
+        g_avx_enabled = 1;
+    }
+    
+    // Clean x87 state and default MXCSR (all exceptions masked, round to
+    // nearest). There is one thread of userspace, so this state is never
+    // saved or restored.
+    uint32_t mxcsr = 0x1F80;
+    __asm__ volatile ("fninit");
+    __asm__ volatile ("ldmxcsr %0" : : "m"(mxcsr));
+    
+    g_sse_enabled = 1;
+}
+
+// Set by init_fpu_sse(); userspace checks these before using SIMD
+int sse_enabled() {
+    return g_sse_enabled;
+}
+
+int avx_enabled() {
+    return g_avx_enabled;
+}
+
+// heap_base and heap_size are the userspace heap the loader allocated for
+// this mode, or zero
+void kernel_main(gop_mode_t *gop_mode, uint64_t heap_base, uint64_t heap_size) {
     uint32_t *framebuffer = (uint32_t *)gop_mode->framebuffer_base;
     uint32_t width = gop_mode->info->horizontal_resolution;
     uint32_t height = gop_mode->info->vertical_resolution;
@@ -128,8 +201,16 @@ void kernel_main(gop_mode_t *gop_mode) {
 
     // Initialize PS/2 keyboard controller
     init_ps2_keyboard();
+    
+    // Enable SSE/AVX state for the userspace pixel kernels
+    init_fpu_sse();
 
-    userspace_main(framebuffer, width, height, pitch);
+    userspace_main(framebuffer, width, height, pitch,
+                   gop_mode->info->pixel_format,
+                   gop_mode->info->pixel_information.red_mask,
+                   gop_mode->info->pixel_information.green_mask,
+                   gop_mode->info->pixel_information.blue_mask,
+                   (void *)heap_base, heap_size);
 
     while(1) {
         __asm__("hlt");
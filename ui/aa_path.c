@@ -0,0 +1,342 @@
+#include "aa_path.h"
+
+// Coverage is staged and emitted this many pixels at a time
+#define AA_PATH_CHUNK 256
+
+// A pixel fully inside accumulates AA_PATH_ONE rows of height times twice
+// its width, so column midpoints stay whole numbers
+#define AA_PATH_FULL (2 * AA_PATH_ONE * AA_PATH_ONE)
+
+// Flattening keeps segments within 1/16 px of the true curve
+#define AA_PATH_TOLERANCE_SHIFT 4
+
+// CORDIC rotation angles atan(2^-i) in 2^30 units per turn, and the gain
+// of all 28 rotations, 0.607..., scaled by 2^30. Computed offline.
+#define AA_CORDIC_STEPS 28
+static const int32_t cordic_angles[AA_CORDIC_STEPS] = {
+    134217728, 79233351, 41864727, 21251189, 10666833, 5338616, 2669960,
+    1335061, 667541, 333772, 166886, 83443, 41722, 20861, 10430, 5215,
+    2608, 1304, 652, 326, 163, 81, 41, 20, 10, 5, 3, 1
+};
+#define AA_CORDIC_GAIN 652032874
+
+static uint32_t isqrt64(uint64_t x) {
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > x) bit >>= 2;
+    while (bit != 0) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+static inline int64_t floor_div(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    if (a % b != 0 && (a < 0) != (b < 0)) q--;
+    return q;
+}
+
+void aa_sincos(int32_t angle, int32_t *cos_out, int32_t *sin_out) {
+    // Quarter turn, then the remainder rotated in from +x
+    uint32_t turn = (uint32_t)angle & (AA_ANGLE_TURN - 1);
+    uint32_t quadrant = turn / (AA_ANGLE_TURN / 4);
+    int64_t theta = (int64_t)(turn % (AA_ANGLE_TURN / 4)) * ((1 << 30) / AA_ANGLE_TURN);
+
+    int64_t x = AA_CORDIC_GAIN;
+    int64_t y = 0;
+    for (int i = 0; i < AA_CORDIC_STEPS; i++) {
+        int64_t nx, ny;
+        if (theta >= 0) {
+            nx = x - (y >> i);
+            ny = y + (x >> i);
+            theta -= cordic_angles[i];
+        } else {
+            nx = x + (y >> i);
+            ny = y - (x >> i);
+            theta += cordic_angles[i];
+        }
+        x = nx;
+        y = ny;
+    }
+
+    int32_t c = (int32_t)x, s = (int32_t)y;
+    switch (quadrant) {
+        case 0: *cos_out = c;  *sin_out = s;  break;
+        case 1: *cos_out = -s; *sin_out = c;  break;
+        case 2: *cos_out = -c; *sin_out = -s; break;
+        default: *cos_out = s; *sin_out = -c; break;
+    }
+}
+
+void aa_path_init(aa_path_t *path, aa_line_t *lines, int32_t capacity) {
+    path->lines = lines;
+    path->capacity = lines ? capacity : 0;
+    aa_path_reset(path);
+}
+
+void aa_path_reset(aa_path_t *path) {
+    path->count = 0;
+    path->overflow = 0;
+    path->open = 0;
+    path->start_x = path->start_y = 0;
+    path->x = path->y = 0;
+    path->min_x = path->min_y = INT32_MAX;
+    path->max_x = path->max_y = INT32_MIN;
+}
+
+static void include_point(aa_path_t *path, int32_t x, int32_t y) {
+    if (x < path->min_x) path->min_x = x;
+    if (x > path->max_x) path->max_x = x;
+    if (y < path->min_y) path->min_y = y;
+    if (y > path->max_y) path->max_y = y;
+}
+
+// Horizontal segments sweep no area, so only the pen moves
+static void add_line(aa_path_t *path, int32_t x, int32_t y) {
+    if (y != path->y) {
+        if (path->count < path->capacity) {
+            aa_line_t *line = &path->lines[path->count++];
+            line->x0 = path->x;
+            line->y0 = path->y;
+            line->x1 = x;
+            line->y1 = y;
+        } else {
+            path->overflow = 1;
+        }
+    }
+    include_point(path, x, y);
+    path->x = x;
+    path->y = y;
+}
+
+void aa_path_close(aa_path_t *path) {
+    if (!path->open) return;
+    add_line(path, path->start_x, path->start_y);
+    path->open = 0;
+}
+
+void aa_path_move_to(aa_path_t *path, int32_t x, int32_t y) {
+    aa_path_close(path);
+    path->start_x = path->x = x;
+    path->start_y = path->y = y;
+    path->open = 1;
+    include_point(path, x, y);
+}
+
+void aa_path_line_to(aa_path_t *path, int32_t x, int32_t y) {
+    if (!path->open) {
+        aa_path_move_to(path, x, y);
+        return;
+    }
+    add_line(path, x, y);
+}
+
+// The curve strays from its chord by at most |p0 - 2c + p1| / 4, and from
+// n chords by that over n^2
+void aa_path_quad_to(aa_path_t *path, int32_t cx, int32_t cy, int32_t x, int32_t y) {
+    if (!path->open) aa_path_move_to(path, path->x, path->y);
+
+    int64_t x0 = path->x, y0 = path->y;
+    int64_t ddx = x0 - 2 * (int64_t)cx + x;
+    int64_t ddy = y0 - 2 * (int64_t)cy + y;
+    if (ddx < 0) ddx = -ddx;
+    if (ddy < 0) ddy = -ddy;
+    int64_t deviation = ddx > ddy ? ddx : ddy;
+
+    // n^2 >= deviation / 4 over the tolerance
+    int64_t n = isqrt64((uint64_t)(deviation << AA_PATH_TOLERANCE_SHIFT) / (4 * AA_PATH_ONE)) + 1;
+    int64_t nn = n * n;
+    for (int64_t i = 1; i < n; i++) {
+        int64_t a = (n - i) * (n - i);
+        int64_t b = 2 * i * (n - i);
+        int64_t c = i * i;
+        add_line(path, (int32_t)((a * x0 + b * cx + c * x) / nn),
+                 (int32_t)((a * y0 + b * cy + c * y) / nn));
+    }
+    add_line(path, x, y);
+}
+
+// A chord spanning angle t sags r t^2 / 8 below its arc, so a full turn
+// needs 2 pi sqrt(r / 8 tolerance) chords
+void aa_path_arc(aa_path_t *path, int32_t cx, int32_t cy, int32_t radius,
+                 int32_t start, int32_t sweep) {
+    if (radius < 0) radius = -radius;
+    int64_t magnitude = sweep < 0 ? -(int64_t)sweep : sweep;
+    if (magnitude > AA_ANGLE_TURN) magnitude = AA_ANGLE_TURN;
+
+    // 2 pi ~= 201 / 32
+    int64_t per_turn = 201 * (int64_t)isqrt64((uint64_t)radius * AA_PATH_ONE
+                                              << (AA_PATH_TOLERANCE_SHIFT - 3)) /
+                       (32 * AA_PATH_ONE);
+    if (per_turn < 8) per_turn = 8;
+    int64_t n = (magnitude * per_turn + AA_ANGLE_TURN - 1) / AA_ANGLE_TURN;
+    if (n < 1) n = 1;
+    int32_t direction = sweep < 0 ? -1 : 1;
+
+    for (int64_t i = 0; i <= n; i++) {
+        int32_t angle = start + direction * (int32_t)(magnitude * i / n);
+        int32_t c, s;
+        aa_sincos(angle, &c, &s);
+        int32_t x = cx + (int32_t)(((int64_t)radius * c + (1 << 29)) >> 30);
+        int32_t y = cy + (int32_t)(((int64_t)radius * s + (1 << 29)) >> 30);
+        if (i == 0 && !path->open) {
+            aa_path_move_to(path, x, y);
+        } else {
+            add_line(path, x, y);
+        }
+    }
+}
+
+void aa_path_bounds(const aa_path_t *path, int32_t *x, int32_t *y, int32_t *w, int32_t *h) {
+    if (path->min_x > path->max_x) {
+        *x = *y = *w = *h = 0;
+        return;
+    }
+    *x = (int32_t)floor_div(path->min_x, AA_PATH_ONE);
+    *y = (int32_t)floor_div(path->min_y, AA_PATH_ONE);
+    *w = (int32_t)floor_div(path->max_x + AA_PATH_ONE - 1, AA_PATH_ONE) - *x;
+    *h = (int32_t)floor_div(path->max_y + AA_PATH_ONE - 1, AA_PATH_ONE) - *y;
+}
+
+// Area swept by a segment lying within 0 <= x <= width and rows
+// [0, rows), relative to the band. For every row it crosses, each column
+// it passes through gains its height there times the part of the column
+// to its right; the column after gains the rest, which the running sum
+// carries on to the end of the row.
+static void accumulate(int32_t *accum, int32_t stride, int32_t rows, int64_t direction,
+                       int64_t x0, int64_t y0, int64_t x1, int64_t y1) {
+    if (y0 > y1) {
+        int64_t t = x0; x0 = x1; x1 = t;
+        t = y0; y0 = y1; y1 = t;
+        direction = -direction;
+    }
+    int64_t top = y0 > 0 ? y0 : 0;
+    int64_t bottom = y1 < (int64_t)rows * AA_PATH_ONE ? y1 : (int64_t)rows * AA_PATH_ONE;
+    if (top >= bottom) return;
+
+    int64_t dx = x1 - x0, dy = y1 - y0;
+    for (int64_t row = top / AA_PATH_ONE; row * AA_PATH_ONE < bottom; row++) {
+        int64_t ya = row * AA_PATH_ONE > top ? row * AA_PATH_ONE : top;
+        int64_t yb = (row + 1) * AA_PATH_ONE < bottom ? (row + 1) * AA_PATH_ONE : bottom;
+        int64_t xa = x0 + (ya - y0) * dx / dy;
+        int64_t xb = x0 + (yb - y0) * dx / dy;
+        int64_t height = (yb - ya) * direction;
+        int32_t *line = accum + row * stride;
+
+        if (xa > xb) {
+            int64_t t = xa; xa = xb; xb = t;
+        }
+        int64_t first = xa / AA_PATH_ONE;
+        int64_t last = xb > xa ? (xb - 1) / AA_PATH_ONE : first;
+        if (first == last) {
+            int64_t mid = xa + xb - 2 * first * AA_PATH_ONE;
+            line[first] += (int32_t)(height * (2 * AA_PATH_ONE - mid));
+            line[first + 1] += (int32_t)(height * mid);
+            continue;
+        }
+
+        // Split the height between columns by the width crossed in each,
+        // from cumulative totals so the parts add up exactly
+        int64_t done = 0;
+        for (int64_t col = first; col <= last; col++) {
+            int64_t left = col * AA_PATH_ONE > xa ? col * AA_PATH_ONE : xa;
+            int64_t right = (col + 1) * AA_PATH_ONE < xb ? (col + 1) * AA_PATH_ONE : xb;
+            int64_t total = height * (right - xa) / (xb - xa);
+            int64_t part = total - done;
+            done = total;
+
+            int64_t mid = left + right - 2 * col * AA_PATH_ONE;
+            line[col] += (int32_t)(part * (2 * AA_PATH_ONE - mid));
+            line[col + 1] += (int32_t)(part * mid);
+        }
+    }
+}
+
+// Pieces left of the band sweep whole rows, so they are pressed against
+// its left edge; pieces right of it change nothing inside it
+static void accumulate_clipped(int32_t *accum, int32_t stride, int32_t rows, int64_t width,
+                               int64_t x0, int64_t y0, int64_t x1, int64_t y1) {
+    // Walk left to right, remembering which way the segment really runs
+    int64_t direction = 1;
+    if (x0 > x1) {
+        int64_t t = x0; x0 = x1; x1 = t;
+        t = y0; y0 = y1; y1 = t;
+        direction = -1;
+    }
+    if (x0 >= width) return;
+    if (x1 > width) {
+        int64_t y = y0 + (width - x0) * (y1 - y0) / (x1 - x0);
+        x1 = width;
+        y1 = y;
+    }
+    if (x1 <= 0) {
+        accumulate(accum, stride, rows, direction, 0, y0, 0, y1);
+        return;
+    }
+    if (x0 < 0) {
+        int64_t y = y0 + (0 - x0) * (y1 - y0) / (x1 - x0);
+        accumulate(accum, stride, rows, direction, 0, y0, 0, y);
+        x0 = 0;
+        y0 = y;
+    }
+    accumulate(accum, stride, rows, direction, x0, y0, x1, y1);
+}
+
+void aa_path_fill(const aa_path_t *path, int32_t x, int32_t y, int32_t w, int32_t h,
+                  int32_t *accum, int32_t accum_size, aa_span_fn emit, void *ctx) {
+    if (w <= 0 || h <= 0 || path->count == 0) return;
+
+    int32_t stride = w + 2;
+    int32_t band = accum_size / stride;
+    if (band < 1) return;
+
+    int64_t width = (int64_t)w * AA_PATH_ONE;
+    uint8_t coverage[AA_PATH_CHUNK];
+
+    for (int32_t band_y = y; band_y < y + h; band_y += band) {
+        int32_t rows = y + h - band_y;
+        if (rows > band) rows = band;
+        for (int32_t i = 0; i < rows * stride; i++) accum[i] = 0;
+
+        int64_t ox = (int64_t)x * AA_PATH_ONE;
+        int64_t oy = (int64_t)band_y * AA_PATH_ONE;
+        for (int32_t i = 0; i < path->count; i++) {
+            const aa_line_t *line = &path->lines[i];
+            accumulate_clipped(accum, stride, rows, width, line->x0 - ox, line->y0 - oy,
+                               line->x1 - ox, line->y1 - oy);
+        }
+        if (path->open) {
+            accumulate_clipped(accum, stride, rows, width, path->x - ox, path->y - oy,
+                               path->start_x - ox, path->start_y - oy);
+        }
+
+        // One running sum per row; only runs with coverage are emitted
+        for (int32_t row = 0; row < rows; row++) {
+            const int32_t *line = accum + row * stride;
+            int32_t sum = 0;
+            int32_t run_start = 0;
+            int32_t run = 0;
+            for (int32_t i = 0; i < w; i++) {
+                sum += line[i];
+                int32_t area = sum < 0 ? -sum : sum;
+                if (area > AA_PATH_FULL) area = AA_PATH_FULL;
+                uint8_t c = (uint8_t)(((int64_t)area * 255 + AA_PATH_FULL / 2) / AA_PATH_FULL);
+
+                if (c != 0) {
+                    if (run == 0) run_start = i;
+                    coverage[run++] = c;
+                }
+                if (run > 0 && (c == 0 || run == AA_PATH_CHUNK || i == w - 1)) {
+                    emit(ctx, x + run_start, band_y + row, coverage, run);
+                    run = 0;
+                }
+            }
+        }
+    }
+}
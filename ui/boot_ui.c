@@ -1,4 +1,6 @@
 #include "boot_ui.h"
+#include "aa_coverage.h"
+#include "aa_path.h"
 #include <efi.h>
 #include <efilib.h>
 
@@ -13,17 +15,6 @@ static INT32 abs_int(INT32 x) {
     return x < 0 ? -x : x;
 }
 
-static UINT32 sqrt_approx(UINT32 n) {
-    if (n == 0) return 0;
-    UINT32 x = n;
-    UINT32 y = (x + 1) / 2;
-    while (y < x) {
-        x = y;
-        y = (x + n / x) / 2;
-    }
-    return x;
-}
-
 EFI_STATUS init_boot_ui(EFI_GRAPHICS_OUTPUT_PROTOCOL *gop) {
     screen_width = gop->Mode->Info->HorizontalResolution;
     screen_height = gop->Mode->Info->VerticalResolution;
@@ -113,61 +104,123 @@ void draw_rectangle(EFI_GRAPHICS_OUTPUT_PROTOCOL *gop, UINT32 x, UINT32 y,
     }
 }
 
+// Coverage is computed this many pixels at a time
+#define AA_CHUNK 256
+
+// Ring outlines and their accumulation buffer. A ring of radius 80 takes
+// about 170 segments; the buffer holds a 200 px wide band of 40 rows.
+#define RING_LINES 512
+#define RING_ACCUM 8192
+static aa_line_t ring_lines[RING_LINES];
+static INT32 ring_accum[RING_ACCUM];
+
+typedef struct {
+    INT32 cx, cy;
+    UINT32 color_start;
+    UINT32 color_end;
+    UINT32 glow;
+} ring_paint_t;
+
+// Path coverage to ring pixels. The angle only picks the color along the
+// ring's gradient; coverage, and so the cut at progress, is exact.
+static void paint_ring_span(void *ctx, INT32 x, INT32 y, const UINT8 *coverage, INT32 count) {
+    ring_paint_t *paint = (ring_paint_t *)ctx;
+    UINT32 row_offset = (UINT32)y * screen_width;
+    INT32 dy = y - paint->cy;
+    
+    for (INT32 i = 0; i < count; i++) {
+        INT32 dx = x + i - paint->cx;
+        INT32 angle = 0;
+        if (dx >= 0 && dy >= 0) {
+            angle = (dy * 90) / (abs_int(dx) + abs_int(dy) + 1);
+        } else if (dx < 0 && dy >= 0) {
+            angle = 90 + (abs_int(dx) * 90) / (abs_int(dx) + abs_int(dy) + 1);
+        } else if (dx < 0 && dy < 0) {
+            angle = 180 + (abs_int(dy) * 90) / (abs_int(dx) + abs_int(dy) + 1);
+        } else {
+            angle = 270 + (dx * 90) / (abs_int(dx) + abs_int(dy) + 1);
+        }
+        
+        UINT32 ring_color = lerp_color(paint->color_start, paint->color_end, angle, 360);
+        UINT32 alpha = coverage[i];
+        if (paint->glow > 0) {
+            alpha = (alpha * (100 + paint->glow)) / 100;
+            if (alpha > 255) alpha = 255;
+        }
+        UINT32 px = (UINT32)(x + i);
+        backbuffer[row_offset + px] = blend_color(ring_color, backbuffer[row_offset + px], alpha);
+    }
+}
+
 // Draw anti-aliased ring
 static void draw_ring(UINT32 cx, UINT32 cy, UINT32 radius, UINT32 thickness,
                      UINT32 color_start, UINT32 color_end, UINT32 progress, UINT32 glow) {
-    UINT32 inner_r = radius - thickness / 2;
-    UINT32 outer_r = radius + thickness / 2;
+    // Edges sit thickness / 2 either side of radius around the center
+    // pixel's center. Until it completes, the ring is the sector swept
+    // clockwise from three o'clock through progress degrees.
+    INT32 ox = (INT32)cx * AA_PATH_ONE + AA_PATH_ONE / 2;
+    INT32 oy = (INT32)cy * AA_PATH_ONE + AA_PATH_ONE / 2;
+    INT32 inner = ((INT32)radius * 2 - (INT32)thickness) * AA_PATH_ONE / 2;
+    INT32 outer = ((INT32)radius * 2 + (INT32)thickness) * AA_PATH_ONE / 2;
+    INT32 sweep = (INT32)progress * AA_ANGLE_TURN / 360;
+    
+    aa_path_t path;
+    aa_path_init(&path, ring_lines, RING_LINES);
+    if (progress >= 360) {
+        aa_path_arc(&path, ox, oy, outer, 0, AA_ANGLE_TURN);
+        aa_path_close(&path);
+        aa_path_arc(&path, ox, oy, inner, 0, -AA_ANGLE_TURN);
+    } else {
+        aa_path_arc(&path, ox, oy, outer, 0, sweep);
+        aa_path_arc(&path, ox, oy, inner, sweep, -sweep);
+    }
+    aa_path_close(&path);
     
+    INT32 px, py, pw, ph;
+    aa_path_bounds(&path, &px, &py, &pw, &ph);
+    if (px < 0) { pw += px; px = 0; }
+    if (py < 0) { ph += py; py = 0; }
+    if (px + pw > (INT32)screen_width) pw = (INT32)screen_width - px;
+    if (py + ph > (INT32)screen_height) ph = (INT32)screen_height - py;
+    
+    ring_paint_t paint = {(INT32)cx, (INT32)cy, color_start, color_end, glow};
+    aa_path_fill(&path, px, py, pw, ph, ring_accum, RING_ACCUM, paint_ring_span, &paint);
+    
+    if (glow == 0) return;
+    
+    // The glow fades out over 8 pixels past the outer edge of the finished
+    // ring, over what it already drew
+    UINT32 outer_r = radius + thickness / 2;
     UINT32 x_min = (cx > outer_r + 10) ? cx - outer_r - 10 : 0;
     UINT32 x_max = (cx + outer_r + 10 < screen_width) ? cx + outer_r + 10 : screen_width;
     UINT32 y_min = (cy > outer_r + 10) ? cy - outer_r - 10 : 0;
     UINT32 y_max = (cy + outer_r + 10 < screen_height) ? cy + outer_r + 10 : screen_height;
     
+    INT32 ring_outer = (INT32)radius * AA_SUBPIXEL + (INT32)thickness * AA_SUBPIXEL / 2;
+    INT32 glow_radius = ring_outer + 4 * AA_SUBPIXEL;
+    UINT8 body[AA_CHUNK];
+    UINT8 halo[AA_CHUNK];
+    UINT32 glow_color = lerp_color(color_start, color_end, 180, 360);
+    
     for (UINT32 y = y_min; y < y_max; y++) {
         UINT32 row_offset = y * screen_width;
-        for (UINT32 x = x_min; x < x_max; x++) {
-            INT32 dx = (INT32)x - (INT32)cx;
-            INT32 dy = (INT32)y - (INT32)cy;
-            UINT32 dist = sqrt_approx(dx * dx + dy * dy);
-            
-            INT32 angle = 0;
-            if (dx >= 0 && dy >= 0) {
-                angle = (dy * 90) / (abs_int(dx) + abs_int(dy) + 1);
-            } else if (dx < 0 && dy >= 0) {
-                angle = 90 + (abs_int(dx) * 90) / (abs_int(dx) + abs_int(dy) + 1);
-            } else if (dx < 0 && dy < 0) {
-                angle = 180 + (abs_int(dy) * 90) / (abs_int(dx) + abs_int(dy) + 1);
-            } else {
-                angle = 270 + (dx * 90) / (abs_int(dx) + abs_int(dy) + 1);
-            }
+        INT32 dy = (INT32)y - (INT32)cy;
+        
+        for (UINT32 span_x = x_min; span_x < x_max; span_x += AA_CHUNK) {
+            INT32 count = (INT32)(x_max - span_x);
+            if (count > AA_CHUNK) count = AA_CHUNK;
+            INT32 dx0 = (INT32)span_x - (INT32)cx;
             
-            if (angle > (INT32)progress) continue;
+            aa_disc_span(body, dx0, dy, count, ring_outer, AA_SUBPIXEL);
+            aa_disc_span(halo, dx0, dy, count, glow_radius, 8 * AA_SUBPIXEL);
             
-            if (dist >= inner_r && dist <= outer_r) {
-                UINT32 ring_color = lerp_color(color_start, color_end, angle, 360);
-                INT32 dist_from_center = abs_int((INT32)dist - (INT32)radius);
-                UINT32 alpha = 255;
-                if (dist_from_center > (INT32)(thickness / 2 - 2)) {
-                    alpha = 255 - ((dist_from_center - thickness / 2 + 2) * 255) / 2;
-                    if (alpha > 255) alpha = 0;
-                }
-                
-                if (glow > 0) {
-                    alpha = (alpha * (100 + glow)) / 100;
-                    if (alpha > 255) alpha = 255;
-                }
+            for (INT32 i = 0; i < count; i++) {
+                if (halo[i] <= body[i]) continue;
                 
-                UINT32 bg = backbuffer[row_offset + x];
-                backbuffer[row_offset + x] = blend_color(ring_color, bg, alpha);
-            } else if (glow > 0 && dist > outer_r && dist < outer_r + 8) {
-                UINT32 glow_dist = dist - outer_r;
-                UINT32 glow_alpha = (glow * (8 - glow_dist)) / 16;
-                if (glow_alpha > 0) {
-                    UINT32 ring_color = lerp_color(color_start, color_end, 180, 360);
-                    UINT32 bg = backbuffer[row_offset + x];
-                    backbuffer[row_offset + x] = blend_color(ring_color, bg, glow_alpha);
-                }
+                UINT32 glow_alpha = (glow * (halo[i] - body[i])) / 512;
+                UINT32 px = span_x + i;
+                backbuffer[row_offset + px] = blend_color(glow_color, backbuffer[row_offset + px],
+                                                          glow_alpha);
             }
         }
     }
@@ -182,23 +235,27 @@ static void draw_core(UINT32 cx, UINT32 cy, UINT32 pulse_frame) {
     
     UINT32 core_color = 0x0006b6d4;
     
-    for (UINT32 y = (cy > radius ? cy - radius : 0); 
-         y < cy + radius && y < screen_height; y++) {
+    // Whole pixels out to radius are covered, so the edge sits half a
+    // pixel past it
+    INT32 edge = (INT32)radius * AA_SUBPIXEL + AA_SUBPIXEL / 2;
+    UINT32 x_min = cx > radius + 1 ? cx - radius - 1 : 0;
+    UINT32 x_max = cx + radius + 2 < screen_width ? cx + radius + 2 : screen_width;
+    UINT8 coverage[AA_CHUNK];
+    
+    for (UINT32 y = (cy > radius + 1 ? cy - radius - 1 : 0); 
+         y < cy + radius + 2 && y < screen_height; y++) {
         UINT32 row_offset = y * screen_width;
-        for (UINT32 x = (cx > radius ? cx - radius : 0); 
-             x < cx + radius && x < screen_width; x++) {
-            INT32 dx = (INT32)x - (INT32)cx;
-            INT32 dy = (INT32)y - (INT32)cy;
-            UINT32 dist = sqrt_approx(dx * dx + dy * dy);
+        INT32 count = (INT32)(x_max - x_min);
+        if (count > AA_CHUNK) count = AA_CHUNK;
+        aa_disc_span(coverage, (INT32)x_min - (INT32)cx, (INT32)y - (INT32)cy, count,
+                     edge, AA_SUBPIXEL);
+        
+        for (INT32 i = 0; i < count; i++) {
+            if (coverage[i] == 0) continue;
             
-            if (dist <= radius) {
-                UINT32 alpha = 200;
-                if (dist == radius) alpha = 100;
-                else if (dist == radius - 1) alpha = 150;
-                
-                UINT32 bg = backbuffer[row_offset + x];
-                backbuffer[row_offset + x] = blend_color(core_color, bg, alpha);
-            }
+            UINT32 alpha = (200 * coverage[i]) / 255;
+            UINT32 bg = backbuffer[row_offset + x_min + i];
+            backbuffer[row_offset + x_min + i] = blend_color(core_color, bg, alpha);
         }
     }
 }
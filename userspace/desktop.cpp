@@ -22,15 +22,17 @@ void DesktopManager::render() {
                                Renderer::Color(6, 182, 212));
     
     // Clock placeholder
-    m_fontRenderer.drawText(m_renderer.width() - 100, m_renderer.height() - 32, 
-                           "14:23", Renderer::Color(200, 200, 200), 2);
+    m_fontRenderer.drawSmoothText(m_renderer.width() - 100, m_renderer.height() - 32, 
+                                 "14:23", Renderer::Color(200, 200, 200), 2 * FontRenderer::SCALE_ONE);
     
     // Welcome message
-    m_fontRenderer.drawTextCentered(100, "WELCOME TO HACOS", 
-                                   Renderer::Color(6, 182, 212), 3);
+    m_fontRenderer.drawSmoothTextCentered(100, "WELCOME TO HACOS", 
+                                         Renderer::Color(6, 182, 212), 3 * FontRenderer::SCALE_ONE);
     
     m_fontRenderer.drawTextCentered(160, "DESKTOP ENVIRONMENT READY", 
                                    Renderer::Color(150, 150, 150), 1);
+    
+    m_renderer.present();
 }
 
 void DesktopManager::run() {
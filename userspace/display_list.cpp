@@ -0,0 +1,528 @@
+#include "display_list.h"
+#include "gfx_effects.h"
+#include "memory.h"
+
+DisplayList::DisplayList(int capacity, int maxHeight)
+    : m_commands(nullptr), m_bin(nullptr), m_visibility(nullptr), m_visibleRects(nullptr),
+      m_rowIntervals(nullptr), m_rowCounts(nullptr), m_rowCapacity(0),
+      m_capacity(0), m_count(0), m_culledCount(0), m_overflowed(false), m_culled(false),
+      m_cullTarget{0, 0, 0, 0}, m_stats{0, 0, 0},
+      m_backend(BACKEND_IMMEDIATE), m_tileSize(DEFAULT_TILE_SIZE) {
+    // Bin entries are 16-bit
+    if (capacity > 65535) capacity = 65535;
+    m_commands = new Command[capacity];
+    m_bin = new uint16_t[capacity];
+    m_visibility = new Visibility[capacity];
+    // Shared by all partly hidden commands; one that finds it full is drawn whole
+    m_visibleRects = new Renderer::Rect[capacity * 2];
+    if (m_commands && m_bin && m_visibility && m_visibleRects) m_capacity = capacity;
+    
+    if (maxHeight > 0) {
+        m_rowIntervals = new Interval[maxHeight * MAX_ROW_INTERVALS];
+        m_rowCounts = new uint8_t[maxHeight];
+        if (m_rowIntervals && m_rowCounts) m_rowCapacity = maxHeight;
+    }
+}
+
+DisplayList::~DisplayList() {
+    delete[] m_commands;
+    delete[] m_bin;
+    delete[] m_visibility;
+    delete[] m_visibleRects;
+    delete[] m_rowIntervals;
+    delete[] m_rowCounts;
+}
+
+void DisplayList::setBackend(Backend backend, int tileSize) {
+    m_backend = backend;
+    m_tileSize = tileSize > 0 ? tileSize : DEFAULT_TILE_SIZE;
+}
+
+void DisplayList::reset() {
+    m_count = 0;
+    m_culledCount = 0;
+    m_overflowed = false;
+    m_culled = false;
+}
+
+DisplayList::Command* DisplayList::append(CommandType type, Renderer::Color color) {
+    if (m_count == m_capacity) {
+        m_overflowed = true;
+        return nullptr;
+    }
+
+    m_culled = false;
+    Command* cmd = &m_commands[m_count++];
+    *cmd = Command();
+    cmd->type = type;
+    cmd->color = color;
+    return cmd;
+}
+
+static inline bool sameColor(const Renderer::Color& a, const Renderer::Color& b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+static inline bool rectContains(const Renderer::Rect& outer, const Renderer::Rect& inner) {
+    return inner.x >= outer.x && inner.y >= outer.y &&
+           inner.x + inner.w <= outer.x + outer.w &&
+           inner.y + inner.h <= outer.y + outer.h;
+}
+
+static inline int64_t rectArea(const Renderer::Rect& r) {
+    return (int64_t)r.w * r.h;
+}
+
+static inline bool sameRect(const Renderer::Rect& a, const Renderer::Rect& b) {
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+static inline bool rectsOverlap(const Renderer::Rect& a, const Renderer::Rect& b) {
+    return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+static Renderer::Rect intersect(const Renderer::Rect& a, const Renderer::Rect& b) {
+    int x0 = a.x > b.x ? a.x : b.x;
+    int y0 = a.y > b.y ? a.y : b.y;
+    int x1 = (a.x + a.w) < (b.x + b.w) ? (a.x + a.w) : (b.x + b.w);
+    int y1 = (a.y + a.h) < (b.y + b.h) ? (a.y + a.h) : (b.y + b.h);
+    if (x1 <= x0 || y1 <= y0) return Renderer::Rect{x0, y0, 0, 0};
+    return Renderer::Rect{x0, y0, x1 - x0, y1 - y0};
+}
+
+// Fold a rect fill into the previous command if that is a fill of the
+// same color sharing a full edge with it. Translucent fills only merge
+// when they do not overlap, so nothing is blended twice or skipped.
+bool DisplayList::mergeRect(int x, int y, int width, int height, Renderer::Color color) {
+    if (m_count == 0) return false;
+
+    Command& last = m_commands[m_count - 1];
+    if (last.type != CMD_FILL_RECT || !sameColor(last.color, color)) return false;
+
+    // Opaque fills are idempotent, so one already covered adds nothing
+    Renderer::Rect prev{last.x, last.y, last.w, last.h};
+    if (color.a == 255 && rectContains(prev, Renderer::Rect{x, y, width, height})) return true;
+
+    if (last.y == y && last.h == height) {
+        if (last.x + last.w == x) {
+            last.w += width;
+            return true;
+        }
+        if (x + width == last.x) {
+            last.x = x;
+            last.w += width;
+            return true;
+        }
+    }
+
+    if (last.x == x && last.w == width) {
+        if (last.y + last.h == y) {
+            last.h += height;
+            return true;
+        }
+        if (y + height == last.y) {
+            last.y = y;
+            last.h += height;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void DisplayList::clear(Renderer::Color color) {
+    append(CMD_CLEAR, color);
+}
+
+void DisplayList::fillRect(int x, int y, int width, int height, Renderer::Color color) {
+    if (width <= 0 || height <= 0 || color.a == 0) return;
+    if (mergeRect(x, y, width, height, color)) {
+        m_culled = false;
+        return;
+    }
+
+    Command* cmd = append(CMD_FILL_RECT, color);
+    if (!cmd) return;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->w = width;
+    cmd->h = height;
+}
+
+void DisplayList::fillCircle(int cx, int cy, int radius, Renderer::Color color) {
+    Command* cmd = append(CMD_FILL_CIRCLE, color);
+    if (!cmd) return;
+    cmd->x = cx;
+    cmd->y = cy;
+    cmd->r = radius;
+}
+
+void DisplayList::circle(int cx, int cy, int radius, Renderer::Color color) {
+    Command* cmd = append(CMD_CIRCLE, color);
+    if (!cmd) return;
+    cmd->x = cx;
+    cmd->y = cy;
+    cmd->r = radius;
+}
+
+void DisplayList::roundedRect(int x, int y, int width, int height, int radius, Renderer::Color color) {
+    Command* cmd = append(CMD_ROUNDED_RECT, color);
+    if (!cmd) return;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->w = width;
+    cmd->h = height;
+    cmd->r = radius;
+}
+
+void DisplayList::aaCircle(int cx, int cy, int radius, Renderer::Color color) {
+    Command* cmd = append(CMD_AA_CIRCLE, color);
+    if (!cmd) return;
+    cmd->x = cx;
+    cmd->y = cy;
+    cmd->r = radius;
+}
+
+void DisplayList::line(int x0, int y0, int x1, int y1, int width, Renderer::Color color) {
+    if (width <= 0) return;
+
+    Command* cmd = append(CMD_LINE, color);
+    if (!cmd) return;
+    cmd->x = x0;
+    cmd->y = y0;
+    cmd->w = x1;
+    cmd->h = y1;
+    cmd->r = width;
+}
+
+void DisplayList::gradient(int x, int y, int width, int height,
+                           Renderer::Color c1, Renderer::Color c2, bool horizontal) {
+    if (width <= 0 || height <= 0) return;
+
+    Command* cmd = append(CMD_GRADIENT, c1);
+    if (!cmd) return;
+    cmd->color2 = c2;
+    cmd->horizontal = horizontal;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->w = width;
+    cmd->h = height;
+}
+
+// Everything a command may touch, matching what the primitive damages
+Renderer::Rect DisplayList::bounds(const Command& cmd) {
+    switch (cmd.type) {
+        case CMD_CLEAR:
+            return Renderer::Rect{-32768, -32768, 65536, 65536};
+        case CMD_FILL_RECT:
+            return Renderer::Rect{cmd.x, cmd.y, cmd.w, cmd.h};
+        case CMD_FILL_CIRCLE:
+            return Renderer::Rect{cmd.x - cmd.r, cmd.y - cmd.r, 2 * cmd.r + 1, 2 * cmd.r + 1};
+        case CMD_CIRCLE:
+            return Renderer::Rect{cmd.x - cmd.r - 1, cmd.y - cmd.r - 1, 2 * cmd.r + 3, 2 * cmd.r + 3};
+        case CMD_ROUNDED_RECT:
+            return Renderer::Rect{cmd.x, cmd.y, cmd.w + 1, cmd.h + 1};
+        case CMD_AA_CIRCLE:
+            return Renderer::Rect{cmd.x - cmd.r - 2, cmd.y - cmd.r - 2, 2 * cmd.r + 5, 2 * cmd.r + 5};
+        case CMD_GRADIENT:
+            return Renderer::Rect{cmd.x, cmd.y, cmd.w, cmd.h};
+        case CMD_LINE: {
+            int reach = cmd.r / 2 + 2;
+            int x0 = cmd.x < cmd.w ? cmd.x : cmd.w;
+            int y0 = cmd.y < cmd.h ? cmd.y : cmd.h;
+            int x1 = cmd.x < cmd.w ? cmd.w : cmd.x;
+            int y1 = cmd.y < cmd.h ? cmd.h : cmd.y;
+            return Renderer::Rect{x0 - reach, y0 - reach, x1 - x0 + 2 * reach + 1, y1 - y0 + 2 * reach + 1};
+        }
+    }
+    return Renderer::Rect{0, 0, 0, 0};
+}
+
+// Walk back to front over the target, in list coordinates. Each target
+// row holds the opaque intervals drawn after the current command; the
+// command's visible part is its bounds minus those, gathered into rects
+// over runs of rows that leave the same gaps.
+void DisplayList::cull(const Renderer::Rect& target) {
+    m_culledCount = 0;
+    m_stats = FrameStats{0, 0, rectArea(target)};
+    m_cullTarget = target;
+    m_culled = true;
+
+    // Without row storage nothing is known to be hidden
+    bool tracking = target.h <= m_rowCapacity;
+    if (tracking) {
+        for (int row = 0; row < target.h; row++) m_rowCounts[row] = 0;
+    }
+
+    int rectCount = 0;
+    int rectCapacity = m_capacity * 2;
+
+    for (int i = m_count - 1; i >= 0; i--) {
+        Command& cmd = m_commands[i];
+        Visibility& vis = m_visibility[i];
+        Renderer::Rect b = intersect(bounds(cmd), target);
+
+        cmd.culled = false;
+        vis.first = rectCount;
+        vis.count = -1;
+        if (b.w <= 0 || b.h <= 0) {
+            cmd.culled = true;
+            vis.count = 0;
+            m_culledCount++;
+            continue;
+        }
+        int64_t area = rectArea(b);
+        if (!tracking) {
+            m_stats.drawnPixels += area;
+            continue;
+        }
+
+        // The row past the last closes the final band
+        Interval band[MAX_ROW_INTERVALS + 1];
+        Interval gaps[MAX_ROW_INTERVALS + 1];
+        int bandCount = -1;
+        int bandY = b.y;
+        int64_t visible = 0;
+        bool whole = false;
+
+        for (int y = b.y; y <= b.y + b.h; y++) {
+            int gapCount = 0;
+            if (y < b.y + b.h) {
+                const Interval* row = m_rowIntervals + (y - target.y) * MAX_ROW_INTERVALS;
+                int n = m_rowCounts[y - target.y];
+                int x = b.x;
+                int end = b.x + b.w;
+                for (int k = 0; k < n && x < end; k++) {
+                    if (row[k].x1 <= x) continue;
+                    if (row[k].x0 >= end) break;
+                    if (row[k].x0 > x) gaps[gapCount++] = Interval{x, row[k].x0};
+                    x = row[k].x1;
+                }
+                if (x < end) gaps[gapCount++] = Interval{x, end};
+                for (int k = 0; k < gapCount; k++) visible += gaps[k].x1 - gaps[k].x0;
+
+                if (gapCount == bandCount) {
+                    bool same = true;
+                    for (int k = 0; k < gapCount && same; k++) {
+                        same = gaps[k].x0 == band[k].x0 && gaps[k].x1 == band[k].x1;
+                    }
+                    if (same) continue;
+                }
+            }
+
+            for (int k = 0; k < bandCount; k++) {
+                if (rectCount - vis.first == MAX_VISIBLE_RECTS || rectCount == rectCapacity) {
+                    whole = true;
+                    break;
+                }
+                m_visibleRects[rectCount++] = Renderer::Rect{band[k].x0, bandY,
+                                                             band[k].x1 - band[k].x0, y - bandY};
+            }
+            for (int k = 0; k < gapCount; k++) band[k] = gaps[k];
+            bandCount = gapCount;
+            bandY = y;
+        }
+
+        if (visible == 0) {
+            cmd.culled = true;
+            vis.count = 0;
+            rectCount = vis.first;
+            m_culledCount++;
+            m_stats.hiddenPixels += area;
+            continue;
+        }
+
+        if (visible == area || whole) {
+            rectCount = vis.first;
+            m_stats.drawnPixels += area;
+        } else {
+            vis.count = rectCount - vis.first;
+            m_stats.drawnPixels += visible;
+            m_stats.hiddenPixels += area - visible;
+        }
+
+        bool opaque = cmd.type == CMD_CLEAR || cmd.type == CMD_GRADIENT ||
+                      (cmd.type == CMD_FILL_RECT && cmd.color.a == 255);
+        if (opaque) occlude(target, b);
+    }
+}
+
+// Add an opaque rect to the intervals of the rows it spans, merging the
+// ones it touches. A row with no room left drops its narrowest interval.
+void DisplayList::occlude(const Renderer::Rect& target, const Renderer::Rect& area) {
+    for (int y = area.y; y < area.y + area.h; y++) {
+        Interval* row = m_rowIntervals + (y - target.y) * MAX_ROW_INTERVALS;
+        int n = m_rowCounts[y - target.y];
+
+        // Intervals are disjoint and apart, so whatever touches the new
+        // one is a single run and merging cannot reach past it
+        Interval merged{area.x, area.x + area.w};
+        for (int k = 0; k < n; k++) {
+            if (row[k].x0 > area.x + area.w || row[k].x1 < area.x) continue;
+            if (row[k].x0 < merged.x0) merged.x0 = row[k].x0;
+            if (row[k].x1 > merged.x1) merged.x1 = row[k].x1;
+        }
+
+        Interval kept[MAX_ROW_INTERVALS + 1];
+        int out = 0;
+        bool placed = false;
+        for (int k = 0; k < n; k++) {
+            if (row[k].x0 >= merged.x0 && row[k].x1 <= merged.x1) continue;
+            if (!placed && row[k].x0 > merged.x1) {
+                kept[out++] = merged;
+                placed = true;
+            }
+            kept[out++] = row[k];
+        }
+        if (!placed) kept[out++] = merged;
+
+        if (out > MAX_ROW_INTERVALS) {
+            int narrowest = 0;
+            for (int k = 1; k < out; k++) {
+                if (kept[k].x1 - kept[k].x0 < kept[narrowest].x1 - kept[narrowest].x0) narrowest = k;
+            }
+            for (int k = narrowest; k < out - 1; k++) kept[k] = kept[k + 1];
+            out--;
+        }
+
+        for (int k = 0; k < out; k++) row[k] = kept[k];
+        m_rowCounts[y - target.y] = (uint8_t)out;
+    }
+}
+
+int DisplayList::overdrawPercent() const {
+    if (m_stats.targetPixels <= 0) return 0;
+    return (int)(m_stats.drawnPixels * 100 / m_stats.targetPixels);
+}
+
+void DisplayList::draw(Renderer& renderer, const Command& cmd, int dx, int dy) {
+    int x = cmd.x + dx;
+    int y = cmd.y + dy;
+
+    switch (cmd.type) {
+        case CMD_CLEAR:
+            renderer.clear(cmd.color);
+            break;
+        case CMD_FILL_RECT:
+            renderer.drawFilledRectangle(x, y, cmd.w, cmd.h, cmd.color);
+            break;
+        case CMD_FILL_CIRCLE:
+            renderer.drawFilledCircle(x, y, cmd.r, cmd.color);
+            break;
+        case CMD_CIRCLE:
+            renderer.drawCircle(x, y, cmd.r, cmd.color);
+            break;
+        case CMD_ROUNDED_RECT:
+            renderer.drawRoundedRect(x, y, cmd.w, cmd.h, cmd.r, cmd.color);
+            break;
+        case CMD_AA_CIRCLE:
+            GfxEffects::aaCircle(renderer, x, y, cmd.r, cmd.color);
+            break;
+        case CMD_GRADIENT:
+            GfxEffects::gradient(renderer, x, y, cmd.w, cmd.h, cmd.color, cmd.color2, cmd.horizontal);
+            break;
+        case CMD_LINE:
+            if (cmd.r == 1) {
+                GfxEffects::aaLine(renderer, x, y, cmd.w + dx, cmd.h + dy, cmd.color);
+            } else {
+                GfxEffects::Point ends[2] = {{x, y}, {cmd.w + dx, cmd.h + dy}};
+                GfxEffects::aaPolyline(renderer, ends, 2, cmd.r, cmd.color);
+            }
+            break;
+    }
+}
+
+// Draw a command in the rects the occlusion pass left visible, or whole.
+// Rects outside tile, when given, are skipped.
+void DisplayList::drawVisible(Renderer& renderer, int index, int dx, int dy,
+                              const Renderer::Rect* tile) {
+    const Visibility& vis = m_visibility[index];
+    // Each visible rect needs a clip slot of its own. Without one the
+    // command is drawn whole, once, which only costs overdraw; drawing it
+    // per rect would blend translucent pixels more than once.
+    if (vis.count < 0 || renderer.clipDepth() >= Renderer::MAX_CLIP_DEPTH) {
+        draw(renderer, m_commands[index], dx, dy);
+        return;
+    }
+
+    for (int k = 0; k < vis.count; k++) {
+        Renderer::Rect r = m_visibleRects[vis.first + k];
+        r.x += dx;
+        r.y += dy;
+        if (tile && !rectsOverlap(r, *tile)) continue;
+
+        renderer.pushClip(r.x, r.y, r.w, r.h);
+        draw(renderer, m_commands[index], dx, dy);
+        renderer.popClip();
+    }
+}
+
+void DisplayList::replay(Renderer& renderer, int dx, int dy) {
+    bool cullable = renderer.blendMode() == Renderer::BLEND_ALPHA;
+    Renderer::Rect clip = renderer.clipRect();
+    Renderer::Rect target{clip.x - dx, clip.y - dy, clip.w, clip.h};
+
+    if (cullable) {
+        if (!m_culled || !sameRect(target, m_cullTarget)) cull(target);
+    } else {
+        // Everything is drawn; the next alpha replay culls again
+        m_culled = false;
+        m_stats = FrameStats{0, 0, rectArea(target)};
+        for (int i = 0; i < m_count; i++) {
+            m_stats.drawnPixels += rectArea(intersect(bounds(m_commands[i]), target));
+        }
+    }
+
+    // Tiles need a free clip slot, or translucent commands would be
+    // drawn whole once per tile
+    if (m_backend == BACKEND_TILED && renderer.clipDepth() < Renderer::MAX_CLIP_DEPTH) {
+        replayTiled(renderer, dx, dy, cullable);
+        return;
+    }
+
+    for (int i = 0; i < m_count; i++) {
+        if (cullable) {
+            drawVisible(renderer, i, dx, dy);
+        } else {
+            draw(renderer, m_commands[i], dx, dy);
+        }
+    }
+}
+
+// Bin commands per row of tiles, then walk the row tile by tile. Every
+// primitive honors the clip exactly, so drawing a command once per tile
+// it touches writes the same pixels as drawing it once in full.
+void DisplayList::replayTiled(Renderer& renderer, int dx, int dy, bool cullable) {
+    Renderer::Rect target = renderer.clipRect();
+    int tile = m_tileSize;
+
+    for (int tileY = target.y; tileY < target.y + target.h; tileY += tile) {
+        int binCount = 0;
+        for (int i = 0; i < m_count; i++) {
+            const Command& cmd = m_commands[i];
+            if (cullable && cmd.culled) continue;
+
+            Renderer::Rect b = bounds(cmd);
+            b.y += dy;
+            if (b.y < tileY + tile && b.y + b.h > tileY) m_bin[binCount++] = (uint16_t)i;
+        }
+        if (binCount == 0) continue;
+
+        for (int tileX = target.x; tileX < target.x + target.w; tileX += tile) {
+            Renderer::Rect tileRect{tileX, tileY, tile, tile};
+            renderer.pushClip(tileX, tileY, tile, tile);
+            for (int k = 0; k < binCount; k++) {
+                const Command& cmd = m_commands[m_bin[k]];
+                Renderer::Rect b = bounds(cmd);
+                b.x += dx;
+                if (b.x >= tileX + tile || b.x + b.w <= tileX) continue;
+                if (cullable) {
+                    drawVisible(renderer, m_bin[k], dx, dy, &tileRect);
+                } else {
+                    draw(renderer, cmd, dx, dy);
+                }
+            }
+            renderer.popClip();
+        }
+    }
+}
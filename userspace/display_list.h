@@ -0,0 +1,149 @@
+#ifndef DISPLAY_LIST_H
+#define DISPLAY_LIST_H
+
+#include "renderer.h"
+#include <stdint.h>
+
+// Recorded draw commands, replayed onto a Renderer in one pass.
+//
+// Recording merges a rect fill into the previous command when both have
+// the same color and together form one rect. Before the first replay the
+// list is scanned back to front while each target row collects the
+// intervals that later opaque fills cover. Commands fully under them are
+// skipped and partly hidden ones are drawn only in their visible rects, so
+// a background under a panel is not painted and then overwritten. A list
+// can be replayed any number of times, so a static frame costs no UI code
+// after the first build.
+//
+// The tiled backend bins commands by screen tile and renders each tile
+// start to finish under a tile clip, so its pixels stay in cache across
+// all commands instead of each full-screen pass streaming the frame.
+// Output is identical to the immediate backend.
+class DisplayList {
+public:
+    enum Backend {
+        BACKEND_IMMEDIATE,    // Commands in order over the whole target
+        BACKEND_TILED         // Tile by tile, each with the commands touching it
+    };
+
+    static const int DEFAULT_TILE_SIZE = 64;
+
+    // Commands past capacity are dropped and overflowed() turns true.
+    // Occlusion rows are allocated once for targets up to maxHeight rows,
+    // normally the height of the renderer; taller targets are not culled.
+    DisplayList(int capacity, int maxHeight);
+    ~DisplayList();
+
+    void reset();
+
+    void clear(Renderer::Color color);
+    void fillRect(int x, int y, int width, int height, Renderer::Color color);
+    void fillCircle(int cx, int cy, int radius, Renderer::Color color);
+    void circle(int cx, int cy, int radius, Renderer::Color color);
+    void roundedRect(int x, int y, int width, int height, int radius, Renderer::Color color);
+    void aaCircle(int cx, int cy, int radius, Renderer::Color color);
+    void line(int x0, int y0, int x1, int y1, int width, Renderer::Color color);
+    void gradient(int x, int y, int width, int height,
+                  Renderer::Color c1, Renderer::Color c2, bool horizontal);
+
+    void setBackend(Backend backend, int tileSize = DEFAULT_TILE_SIZE);
+    Backend backend() const { return m_backend; }
+
+    // Draw every visible command, moved by dx, dy, with the renderer's
+    // current clip and blend mode. Occlusion only holds for BLEND_ALPHA;
+    // in other modes everything is drawn.
+    void replay(Renderer& renderer, int dx = 0, int dy = 0);
+
+    // Pixels of the last replay, from command bounds within the target:
+    // drawn, skipped as hidden under later opaque fills, and the target
+    // area
+    struct FrameStats {
+        int64_t drawnPixels;
+        int64_t hiddenPixels;
+        int64_t targetPixels;
+    };
+
+    int size() const { return m_count; }
+    int culledCount() const { return m_culledCount; }
+    bool overflowed() const { return m_overflowed; }
+    const FrameStats& frameStats() const { return m_stats; }
+
+    // Drawn pixels per target pixel of the last replay, in percent; 100
+    // when every pixel is written once
+    int overdrawPercent() const;
+
+private:
+    enum CommandType : uint8_t {
+        CMD_CLEAR,
+        CMD_FILL_RECT,
+        CMD_FILL_CIRCLE,
+        CMD_CIRCLE,
+        CMD_ROUNDED_RECT,
+        CMD_AA_CIRCLE,
+        CMD_GRADIENT,
+        CMD_LINE
+    };
+
+    // 32 bytes; circles keep their center in x, y and radius in r, lines
+    // their end in w, h and width in r
+    struct Command {
+        CommandType type;
+        bool culled;
+        bool horizontal;      // Gradient direction
+        Renderer::Color color;
+        Renderer::Color color2;   // Gradient end color
+        int32_t x, y, w, h, r;
+
+        Command() : type(CMD_CLEAR), culled(false), horizontal(false),
+                    color(0, 0, 0), color2(0, 0, 0),
+                    x(0), y(0), w(0), h(0), r(0) {}
+    };
+
+    // Opaque intervals kept per target row while culling; a full row drops
+    // its narrowest, which only costs pixels drawn twice
+    static const int MAX_ROW_INTERVALS = 4;
+
+    // A partly hidden command split into more visible rects than this is
+    // drawn whole instead
+    static const int MAX_VISIBLE_RECTS = 8;
+
+    struct Interval {
+        int32_t x0, x1;
+    };
+
+    // Where a command is drawn: count rects from first in the rect pool,
+    // or the whole command when count is negative
+    struct Visibility {
+        int32_t first;
+        int32_t count;
+    };
+
+    Command* m_commands;
+    uint16_t* m_bin;          // Indices of the commands touching one tile row
+    Visibility* m_visibility;
+    Renderer::Rect* m_visibleRects;
+    Interval* m_rowIntervals; // MAX_ROW_INTERVALS per target row
+    uint8_t* m_rowCounts;
+    int m_rowCapacity;
+    int m_capacity;
+    int m_count;
+    int m_culledCount;
+    bool m_overflowed;
+    bool m_culled;            // Occlusion pass is up to date
+    Renderer::Rect m_cullTarget;  // Target it was made for, in list space
+    FrameStats m_stats;
+    Backend m_backend;
+    int m_tileSize;
+
+    Command* append(CommandType type, Renderer::Color color);
+    bool mergeRect(int x, int y, int width, int height, Renderer::Color color);
+    void cull(const Renderer::Rect& target);
+    void occlude(const Renderer::Rect& target, const Renderer::Rect& area);
+    void draw(Renderer& renderer, const Command& cmd, int dx, int dy);
+    void drawVisible(Renderer& renderer, int index, int dx, int dy,
+                     const Renderer::Rect* tile = nullptr);
+    void replayTiled(Renderer& renderer, int dx, int dy, bool cullable);
+    static Renderer::Rect bounds(const Command& cmd);
+};
+
+#endif // DISPLAY_LIST_H
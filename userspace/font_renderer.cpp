@@ -1,139 +1,988 @@
 #include "font_renderer.h"
+#include "memory.h"
 
-// Global font storage (128 ASCII characters, 8x16 bitmap)
-static uint8_t g_font_glyphs[128][16];
-static bool g_font_initialized = false;
+// Printable ASCII 32-126, 8x16, one byte per row with the leftmost pixel
+// in bit 7. Capitals and digits fill rows 0-11 and descenders reach row
+// 14. Everything below is derived from these tables at compile time, so
+// the font lives in read-only data and needs no setup.
+static const int FIRST_GLYPH = 32;
+static const int ASCII_GLYPHS = 95;
+static const int GLYPH_ADVANCE = 10;    // Cell width 8 plus 2 spacing
 
-static void init_font_data() {
-    if (g_font_initialized) return;
+static constexpr uint8_t FONT_GLYPHS[ASCII_GLYPHS][16] = {
+    // space (32)
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // ! (33)
+    {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00},
+    // " (34)
+    {0x6C, 0x6C, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // # (35)
+    {0x00, 0x00, 0x24, 0x24, 0xFE, 0x24, 0x24, 0xFE, 0x24, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // $ (36)
+    {0x10, 0x7C, 0x92, 0x90, 0x90, 0x7C, 0x12, 0x12, 0x92, 0x7C, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00},
+    // % (37)
+    {0x62, 0x92, 0x94, 0x64, 0x08, 0x08, 0x10, 0x10, 0x26, 0x29, 0x49, 0x46, 0x00, 0x00, 0x00, 0x00},
+    // & (38)
+    {0x00, 0x30, 0x48, 0x48, 0x50, 0x20, 0x52, 0x8A, 0x84, 0x84, 0x8A, 0x71, 0x00, 0x00, 0x00, 0x00},
+    // ' (39)
+    {0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // ( (40)
+    {0x08, 0x10, 0x20, 0x20, 0x40, 0x40, 0x40, 0x40, 0x20, 0x20, 0x10, 0x08, 0x00, 0x00, 0x00, 0x00},
+    // ) (41)
+    {0x20, 0x10, 0x08, 0x08, 0x04, 0x04, 0x04, 0x04, 0x08, 0x08, 0x10, 0x20, 0x00, 0x00, 0x00, 0x00},
+    // * (42)
+    {0x00, 0x00, 0x10, 0x92, 0x54, 0x38, 0x54, 0x92, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // + (43)
+    {0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0xFE, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // , (44)
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x08, 0x10, 0x00, 0x00},
+    // - (45)
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // . (46)
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00},
+    // / (47)
+    {0x02, 0x02, 0x04, 0x04, 0x08, 0x08, 0x10, 0x10, 0x20, 0x20, 0x40, 0x40, 0x00, 0x00, 0x00, 0x00},
+    // 0 (48)
+    {0x3C, 0x42, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00},
+    // 1 (49)
+    {0x10, 0x30, 0x50, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x7C, 0x00, 0x00, 0x00, 0x00},
+    // 2 (50)
+    {0x3C, 0x42, 0x81, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0xFF, 0x00, 0x00, 0x00, 0x00},
+    // 3 (51)
+    {0x3C, 0x42, 0x01, 0x01, 0x02, 0x1C, 0x02, 0x01, 0x01, 0x01, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00},
+    // 4 (52)
+    {0x04, 0x0C, 0x14, 0x24, 0x44, 0x84, 0xFF, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00},
+    // 5 (53)
+    {0xFF, 0x80, 0x80, 0x80, 0xBC, 0xC2, 0x01, 0x01, 0x01, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00},
+    // 6 (54)
+    {0x3C, 0x42, 0x80, 0x80, 0xBC, 0xC2, 0x81, 0x81, 0x81, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00},
+    // 7 (55)
+    {0xFF, 0x01, 0x02, 0x02, 0x04, 0x04, 0x08, 0x08, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00},
+    // 8 (56)
+    {0x3C, 0x42, 0x81, 0x81, 0x42, 0x3C, 0x42, 0x81, 0x81, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00},
+    // 9 (57)
+    {0x3C, 0x42, 0x81, 0x81, 0x81, 0x81, 0x43, 0x3D, 0x01, 0x01, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00},
+    // : (58)
+    {0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // ; (59)
+    {0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x08, 0x10, 0x00, 0x00, 0x00},
+    // < (60)
+    {0x00, 0x00, 0x04, 0x08, 0x10, 0x20, 0x40, 0x20, 0x10, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // = (61)
+    {0x00, 0x00, 0x00, 0x00, 0xFE, 0x00, 0x00, 0xFE, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // > (62)
+    {0x00, 0x00, 0x40, 0x20, 0x10, 0x08, 0x04, 0x08, 0x10, 0x20, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // ? (63)
+    {0x3C, 0x42, 0x82, 0x02, 0x04, 0x08, 0x10, 0x10, 0x00, 0x00, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00},
+    // @ (64)
+    {0x3C, 0x42, 0x81, 0x9D, 0xA5, 0xA5, 0xA5, 0x9E, 0x80, 0x80, 0x41, 0x3E, 0x00, 0x00, 0x00, 0x00},
+    // A (65)
+    {0x38, 0x44, 0x82, 0x82, 0x82, 0xFE, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00},
+    // B (66)
+    {0xFC, 0x82, 0x82, 0x82, 0xFC, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0xFC, 0x00, 0x00, 0x00, 0x00},
+    // C (67)
+    {0x3C, 0x42, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00},
+    // D (68)
+    {0xFC, 0x82, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x82, 0xFC, 0x00, 0x00, 0x00, 0x00},
+    // E (69)
+    {0xFE, 0x80, 0x80, 0x80, 0xFC, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xFE, 0x00, 0x00, 0x00, 0x00},
+    // F (70)
+    {0xFE, 0x80, 0x80, 0x80, 0xFC, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00},
+    // G (71)
+    {0x3C, 0x42, 0x80, 0x80, 0x80, 0x8E, 0x82, 0x82, 0x82, 0x82, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00},
+    // H (72)
+    {0x82, 0x82, 0x82, 0x82, 0xFE, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00},
+    // I (73)
+    {0x7C, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x7C, 0x00, 0x00, 0x00, 0x00},
+    // J (74)
+    {0x3E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x88, 0x88, 0x70, 0x00, 0x00, 0x00, 0x00},
+    // K (75)
+    {0x82, 0x84, 0x88, 0x90, 0xE0, 0x90, 0x88, 0x84, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00},
+    // L (76)
+    {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xFE, 0x00, 0x00, 0x00, 0x00},
+    // M (77)
+    {0x82, 0xC6, 0xAA, 0x92, 0x92, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00},
+    // N (78)
+    {0x82, 0xC2, 0xA2, 0x92, 0x8A, 0x86, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00},
+    // O (79)
+    {0x3C, 0x42, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00},
+    // P (80)
+    {0xFC, 0x82, 0x82, 0x82, 0xFC, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00},
+    // Q (81)
+    {0x3C, 0x42, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x89, 0x46, 0x3D, 0x00, 0x00, 0x00, 0x00},
+    // R (82)
+    {0xFC, 0x82, 0x82, 0x82, 0xFC, 0x90, 0x88, 0x84, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00},
+    // S (83)
+    {0x3E, 0x41, 0x80, 0x80, 0x40, 0x3C, 0x02, 0x01, 0x01, 0x01, 0x82, 0x7C, 0x00, 0x00, 0x00, 0x00},
+    // T (84)
+    {0xFE, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00},
+    // U (85)
+    {0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00},
+    // V (86)
+    {0x82, 0x82, 0x82, 0x82, 0x44, 0x44, 0x44, 0x28, 0x28, 0x28, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00},
+    // W (87)
+    {0x82, 0x82, 0x82, 0x92, 0x92, 0x92, 0xAA, 0xAA, 0xAA, 0x44, 0x44, 0x44, 0x00, 0x00, 0x00, 0x00},
+    // X (88)
+    {0x82, 0x82, 0x44, 0x44, 0x28, 0x10, 0x28, 0x44, 0x44, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00},
+    // Y (89)
+    {0x82, 0x82, 0x44, 0x44, 0x28, 0x28, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00},
+    // Z (90)
+    {0xFE, 0x02, 0x04, 0x08, 0x10, 0x10, 0x20, 0x40, 0x80, 0x80, 0x80, 0xFE, 0x00, 0x00, 0x00, 0x00},
+    // [ (91)
+    {0x38, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x38, 0x00, 0x00, 0x00, 0x00},
+    // \ (92)
+    {0x40, 0x40, 0x20, 0x20, 0x10, 0x10, 0x08, 0x08, 0x04, 0x04, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00},
+    // ] (93)
+    {0x38, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x38, 0x00, 0x00, 0x00, 0x00},
+    // ^ (94)
+    {0x10, 0x28, 0x44, 0x82, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // _ (95)
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFE, 0x00, 0x00},
+    // ` (96)
+    {0x20, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    // a (97)
+    {0x00, 0x00, 0x00, 0x00, 0x7C, 0x02, 0x02, 0x7E, 0x82, 0x82, 0x86, 0x7A, 0x00, 0x00, 0x00, 0x00},
+    // b (98)
+    {0x80, 0x80, 0x80, 0x80, 0xBC, 0xC2, 0x82, 0x82, 0x82, 0x82, 0xC2, 0xBC, 0x00, 0x00, 0x00, 0x00},
+    // c (99)
+    {0x00, 0x00, 0x00, 0x00, 0x3C, 0x42, 0x80, 0x80, 0x80, 0x80, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00},
+    // d (100)
+    {0x02, 0x02, 0x02, 0x02, 0x7A, 0x86, 0x82, 0x82, 0x82, 0x82, 0x86, 0x7A, 0x00, 0x00, 0x00, 0x00},
+    // e (101)
+    {0x00, 0x00, 0x00, 0x00, 0x3C, 0x42, 0x82, 0xFE, 0x80, 0x80, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00},
+    // f (102)
+    {0x1C, 0x22, 0x20, 0x20, 0xF8, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x00, 0x00, 0x00, 0x00},
+    // g (103)
+    {0x00, 0x00, 0x00, 0x00, 0x7A, 0x86, 0x82, 0x82, 0x82, 0x82, 0x86, 0x7A, 0x02, 0x84, 0x78, 0x00},
+    // h (104)
+    {0x80, 0x80, 0x80, 0x80, 0xBC, 0xC2, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00},
+    // i (105)
+    {0x00, 0x10, 0x00, 0x00, 0x30, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x38, 0x00, 0x00, 0x00, 0x00},
+    // j (106)
+    {0x00, 0x04, 0x00, 0x00, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x44, 0x38, 0x00},
+    // k (107)
+    {0x80, 0x80, 0x80, 0x80, 0x84, 0x88, 0x90, 0xE0, 0x90, 0x88, 0x84, 0x82, 0x00, 0x00, 0x00, 0x00},
+    // l (108)
+    {0x30, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x38, 0x00, 0x00, 0x00, 0x00},
+    // m (109)
+    {0x00, 0x00, 0x00, 0x00, 0xEC, 0x92, 0x92, 0x92, 0x92, 0x92, 0x92, 0x92, 0x00, 0x00, 0x00, 0x00},
+    // n (110)
+    {0x00, 0x00, 0x00, 0x00, 0xBC, 0xC2, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00},
+    // o (111)
+    {0x00, 0x00, 0x00, 0x00, 0x38, 0x44, 0x82, 0x82, 0x82, 0x82, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00},
+    // p (112)
+    {0x00, 0x00, 0x00, 0x00, 0xBC, 0xC2, 0x82, 0x82, 0x82, 0x82, 0xC2, 0xBC, 0x80, 0x80, 0x80, 0x00},
+    // q (113)
+    {0x00, 0x00, 0x00, 0x00, 0x7A, 0x86, 0x82, 0x82, 0x82, 0x82, 0x86, 0x7A, 0x02, 0x02, 0x02, 0x00},
+    // r (114)
+    {0x00, 0x00, 0x00, 0x00, 0xBC, 0xC2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00},
+    // s (115)
+    {0x00, 0x00, 0x00, 0x00, 0x7C, 0x82, 0x80, 0x70, 0x0C, 0x02, 0x82, 0x7C, 0x00, 0x00, 0x00, 0x00},
+    // t (116)
+    {0x00, 0x20, 0x20, 0x20, 0xF8, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x1C, 0x00, 0x00, 0x00, 0x00},
+    // u (117)
+    {0x00, 0x00, 0x00, 0x00, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x86, 0x7A, 0x00, 0x00, 0x00, 0x00},
+    // v (118)
+    {0x00, 0x00, 0x00, 0x00, 0x82, 0x82, 0x44, 0x44, 0x28, 0x28, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00},
+    // w (119)
+    {0x00, 0x00, 0x00, 0x00, 0x82, 0x82, 0x92, 0x92, 0x92, 0xAA, 0xAA, 0x44, 0x00, 0x00, 0x00, 0x00},
+    // x (120)
+    {0x00, 0x00, 0x00, 0x00, 0x82, 0x44, 0x28, 0x10, 0x10, 0x28, 0x44, 0x82, 0x00, 0x00, 0x00, 0x00},
+    // y (121)
+    {0x00, 0x00, 0x00, 0x00, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x86, 0x7A, 0x02, 0x84, 0x78, 0x00},
+    // z (122)
+    {0x00, 0x00, 0x00, 0x00, 0xFE, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0xFE, 0x00, 0x00, 0x00, 0x00},
+    // { (123)
+    {0x0C, 0x10, 0x10, 0x10, 0x10, 0x60, 0x10, 0x10, 0x10, 0x10, 0x10, 0x0C, 0x00, 0x00, 0x00, 0x00},
+    // | (124)
+    {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00},
+    // } (125)
+    {0x60, 0x10, 0x10, 0x10, 0x10, 0x0C, 0x10, 0x10, 0x10, 0x10, 0x10, 0x60, 0x00, 0x00, 0x00, 0x00},
+    // ~ (126)
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x72, 0x9C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}
+};
+
+// Glyphs past ASCII by code point: Latin-1 letters and signs, typographic
+// punctuation, and U+FFFD, which stands in for code points without a
+// glyph and for malformed UTF-8. Accented capitals are shortened to 9 rows
+// to fit the mark above them.
+struct GlyphRecord {
+    uint32_t codePoint;
+    uint8_t rows[16];
+};
+
+static constexpr GlyphRecord EXTRA_GLYPHS[] = {
+    // U+00A1 Inverted exclamation mark
+    {0x00A1, {0x00, 0x00, 0x10, 0x10, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00}},
+    // U+00A3 Pound sign
+    {0x00A3, {0x1C, 0x22, 0x20, 0x20, 0x20, 0xF8, 0x20, 0x20, 0x20, 0x20, 0x40, 0xFE, 0x00, 0x00, 0x00, 0x00}},
+    // U+00A7 Section sign
+    {0x00A7, {0x3C, 0x42, 0x40, 0x30, 0x48, 0x44, 0x22, 0x12, 0x0C, 0x02, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00}},
+    // U+00A9 Copyright sign
+    {0x00A9, {0x3C, 0x42, 0x81, 0x99, 0xA5, 0xA1, 0xA1, 0xA5, 0x99, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00}},
+    // U+00AB Left-pointing double angle quotation mark
+    {0x00AB, {0x00, 0x00, 0x00, 0x12, 0x24, 0x48, 0x90, 0x48, 0x24, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // U+00B0 Degree sign
+    {0x00B0, {0x30, 0x48, 0x48, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // U+00B7 Middle dot
+    {0x00B7, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // U+00BB Right-pointing double angle quotation mark
+    {0x00BB, {0x00, 0x00, 0x00, 0x90, 0x48, 0x24, 0x12, 0x24, 0x48, 0x90, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // U+00BF Inverted question mark
+    {0x00BF, {0x00, 0x00, 0x10, 0x10, 0x00, 0x00, 0x10, 0x10, 0x08, 0x04, 0x02, 0x82, 0x42, 0x3C, 0x00, 0x00}},
+    // U+00C0 Latin capital letter a with grave
+    {0x00C0, {0x20, 0x10, 0x00, 0x38, 0x44, 0x82, 0x82, 0xFE, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00}},
+    // U+00C1 Latin capital letter a with acute
+    {0x00C1, {0x08, 0x10, 0x00, 0x38, 0x44, 0x82, 0x82, 0xFE, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00}},
+    // U+00C2 Latin capital letter a with circumflex
+    {0x00C2, {0x10, 0x28, 0x00, 0x38, 0x44, 0x82, 0x82, 0xFE, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00}},
+    // U+00C3 Latin capital letter a with tilde
+    {0x00C3, {0x32, 0x4C, 0x00, 0x38, 0x44, 0x82, 0x82, 0xFE, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00}},
+    // U+00C4 Latin capital letter a with diaeresis
+    {0x00C4, {0x00, 0x44, 0x00, 0x38, 0x44, 0x82, 0x82, 0xFE, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00}},
+    // U+00C5 Latin capital letter a with ring above
+    {0x00C5, {0x10, 0x28, 0x10, 0x38, 0x44, 0x82, 0x82, 0xFE, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00}},
+    // U+00C6 Latin capital letter ae
+    {0x00C6, {0x3F, 0x48, 0x88, 0x88, 0x88, 0xFE, 0x88, 0x88, 0x88, 0x88, 0x88, 0x8F, 0x00, 0x00, 0x00, 0x00}},
+    // U+00C7 Latin capital letter c with cedilla
+    {0x00C7, {0x3C, 0x42, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x42, 0x3C, 0x10, 0x20, 0x00, 0x00}},
+    // U+00C8 Latin capital letter e with grave
+    {0x00C8, {0x20, 0x10, 0x00, 0xFE, 0x80, 0x80, 0x80, 0xFC, 0x80, 0x80, 0x80, 0xFE, 0x00, 0x00, 0x00, 0x00}},
+    // U+00C9 Latin capital letter e with acute
+    {0x00C9, {0x08, 0x10, 0x00, 0xFE, 0x80, 0x80, 0x80, 0xFC, 0x80, 0x80, 0x80, 0xFE, 0x00, 0x00, 0x00, 0x00}},
+    // U+00CA Latin capital letter e with circumflex
+    {0x00CA, {0x10, 0x28, 0x00, 0xFE, 0x80, 0x80, 0x80, 0xFC, 0x80, 0x80, 0x80, 0xFE, 0x00, 0x00, 0x00, 0x00}},
+    // U+00CB Latin capital letter e with diaeresis
+    {0x00CB, {0x00, 0x44, 0x00, 0xFE, 0x80, 0x80, 0x80, 0xFC, 0x80, 0x80, 0x80, 0xFE, 0x00, 0x00, 0x00, 0x00}},
+    // U+00CC Latin capital letter i with grave
+    {0x00CC, {0x20, 0x10, 0x00, 0x7C, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x7C, 0x00, 0x00, 0x00, 0x00}},
+    // U+00CD Latin capital letter i with acute
+    {0x00CD, {0x08, 0x10, 0x00, 0x7C, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x7C, 0x00, 0x00, 0x00, 0x00}},
+    // U+00CE Latin capital letter i with circumflex
+    {0x00CE, {0x10, 0x28, 0x00, 0x7C, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x7C, 0x00, 0x00, 0x00, 0x00}},
+    // U+00CF Latin capital letter i with diaeresis
+    {0x00CF, {0x00, 0x44, 0x00, 0x7C, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x7C, 0x00, 0x00, 0x00, 0x00}},
+    // U+00D1 Latin capital letter n with tilde
+    {0x00D1, {0x32, 0x4C, 0x00, 0x82, 0xC2, 0xA2, 0x92, 0x8A, 0x86, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00}},
+    // U+00D2 Latin capital letter o with grave
+    {0x00D2, {0x20, 0x10, 0x00, 0x3C, 0x42, 0x81, 0x81, 0x81, 0x81, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00}},
+    // U+00D3 Latin capital letter o with acute
+    {0x00D3, {0x08, 0x10, 0x00, 0x3C, 0x42, 0x81, 0x81, 0x81, 0x81, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00}},
+    // U+00D4 Latin capital letter o with circumflex
+    {0x00D4, {0x10, 0x28, 0x00, 0x3C, 0x42, 0x81, 0x81, 0x81, 0x81, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00}},
+    // U+00D5 Latin capital letter o with tilde
+    {0x00D5, {0x32, 0x4C, 0x00, 0x3C, 0x42, 0x81, 0x81, 0x81, 0x81, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00}},
+    // U+00D6 Latin capital letter o with diaeresis
+    {0x00D6, {0x00, 0x44, 0x00, 0x3C, 0x42, 0x81, 0x81, 0x81, 0x81, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00}},
+    // U+00D7 Multiplication sign
+    {0x00D7, {0x00, 0x00, 0x00, 0x00, 0x82, 0x44, 0x28, 0x10, 0x28, 0x44, 0x82, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // U+00D8 Latin capital letter o with stroke
+    {0x00D8, {0x3D, 0x42, 0x83, 0x85, 0x85, 0x89, 0x91, 0xA1, 0xA1, 0xC1, 0x42, 0xBC, 0x00, 0x00, 0x00, 0x00}},
+    // U+00D9 Latin capital letter u with grave
+    {0x00D9, {0x20, 0x10, 0x00, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00}},
+    // U+00DA Latin capital letter u with acute
+    {0x00DA, {0x08, 0x10, 0x00, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00}},
+    // U+00DB Latin capital letter u with circumflex
+    {0x00DB, {0x10, 0x28, 0x00, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00}},
+    // U+00DC Latin capital letter u with diaeresis
+    {0x00DC, {0x00, 0x44, 0x00, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00}},
+    // U+00DD Latin capital letter y with acute
+    {0x00DD, {0x08, 0x10, 0x00, 0x82, 0x82, 0x44, 0x44, 0x28, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00}},
+    // U+00DF Latin small letter sharp s
+    {0x00DF, {0x38, 0x44, 0x44, 0x44, 0x48, 0x50, 0x48, 0x44, 0x42, 0x42, 0x44, 0x58, 0x00, 0x00, 0x00, 0x00}},
+    // U+00E0 Latin small letter a with grave
+    {0x00E0, {0x00, 0x20, 0x10, 0x00, 0x7C, 0x02, 0x02, 0x7E, 0x82, 0x82, 0x86, 0x7A, 0x00, 0x00, 0x00, 0x00}},
+    // U+00E1 Latin small letter a with acute
+    {0x00E1, {0x00, 0x08, 0x10, 0x00, 0x7C, 0x02, 0x02, 0x7E, 0x82, 0x82, 0x86, 0x7A, 0x00, 0x00, 0x00, 0x00}},
+    // U+00E2 Latin small letter a with circumflex
+    {0x00E2, {0x00, 0x10, 0x28, 0x00, 0x7C, 0x02, 0x02, 0x7E, 0x82, 0x82, 0x86, 0x7A, 0x00, 0x00, 0x00, 0x00}},
+    // U+00E3 Latin small letter a with tilde
+    {0x00E3, {0x00, 0x32, 0x4C, 0x00, 0x7C, 0x02, 0x02, 0x7E, 0x82, 0x82, 0x86, 0x7A, 0x00, 0x00, 0x00, 0x00}},
+    // U+00E4 Latin small letter a with diaeresis
+    {0x00E4, {0x00, 0x00, 0x44, 0x00, 0x7C, 0x02, 0x02, 0x7E, 0x82, 0x82, 0x86, 0x7A, 0x00, 0x00, 0x00, 0x00}},
+    // U+00E5 Latin small letter a with ring above
+    {0x00E5, {0x10, 0x28, 0x10, 0x00, 0x7C, 0x02, 0x02, 0x7E, 0x82, 0x82, 0x86, 0x7A, 0x00, 0x00, 0x00, 0x00}},
+    // U+00E6 Latin small letter ae
+    {0x00E6, {0x00, 0x00, 0x00, 0x00, 0x6C, 0x12, 0x12, 0x7E, 0x90, 0x90, 0x92, 0x6C, 0x00, 0x00, 0x00, 0x00}},
+    // U+00E7 Latin small letter c with cedilla
+    {0x00E7, {0x00, 0x00, 0x00, 0x00, 0x3C, 0x42, 0x80, 0x80, 0x80, 0x80, 0x42, 0x3C, 0x10, 0x20, 0x00, 0x00}},
+    // U+00E8 Latin small letter e with grave
+    {0x00E8, {0x00, 0x20, 0x10, 0x00, 0x3C, 0x42, 0x82, 0xFE, 0x80, 0x80, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00}},
+    // U+00E9 Latin small letter e with acute
+    {0x00E9, {0x00, 0x08, 0x10, 0x00, 0x3C, 0x42, 0x82, 0xFE, 0x80, 0x80, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00}},
+    // U+00EA Latin small letter e with circumflex
+    {0x00EA, {0x00, 0x10, 0x28, 0x00, 0x3C, 0x42, 0x82, 0xFE, 0x80, 0x80, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00}},
+    // U+00EB Latin small letter e with diaeresis
+    {0x00EB, {0x00, 0x00, 0x44, 0x00, 0x3C, 0x42, 0x82, 0xFE, 0x80, 0x80, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00}},
+    // U+00EC Latin small letter i with grave
+    {0x00EC, {0x00, 0x20, 0x10, 0x00, 0x30, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x38, 0x00, 0x00, 0x00, 0x00}},
+    // U+00ED Latin small letter i with acute
+    {0x00ED, {0x00, 0x08, 0x10, 0x00, 0x30, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x38, 0x00, 0x00, 0x00, 0x00}},
+    // U+00EE Latin small letter i with circumflex
+    {0x00EE, {0x00, 0x10, 0x28, 0x00, 0x30, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x38, 0x00, 0x00, 0x00, 0x00}},
+    // U+00EF Latin small letter i with diaeresis
+    {0x00EF, {0x00, 0x00, 0x28, 0x00, 0x30, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x38, 0x00, 0x00, 0x00, 0x00}},
+    // U+00F1 Latin small letter n with tilde
+    {0x00F1, {0x00, 0x32, 0x4C, 0x00, 0xBC, 0xC2, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00}},
+    // U+00F2 Latin small letter o with grave
+    {0x00F2, {0x00, 0x20, 0x10, 0x00, 0x38, 0x44, 0x82, 0x82, 0x82, 0x82, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00}},
+    // U+00F3 Latin small letter o with acute
+    {0x00F3, {0x00, 0x08, 0x10, 0x00, 0x38, 0x44, 0x82, 0x82, 0x82, 0x82, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00}},
+    // U+00F4 Latin small letter o with circumflex
+    {0x00F4, {0x00, 0x10, 0x28, 0x00, 0x38, 0x44, 0x82, 0x82, 0x82, 0x82, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00}},
+    // U+00F5 Latin small letter o with tilde
+    {0x00F5, {0x00, 0x32, 0x4C, 0x00, 0x38, 0x44, 0x82, 0x82, 0x82, 0x82, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00}},
+    // U+00F6 Latin small letter o with diaeresis
+    {0x00F6, {0x00, 0x00, 0x44, 0x00, 0x38, 0x44, 0x82, 0x82, 0x82, 0x82, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00}},
+    // U+00F7 Division sign
+    {0x00F7, {0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0xFE, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // U+00F8 Latin small letter o with stroke
+    {0x00F8, {0x00, 0x00, 0x00, 0x02, 0x3C, 0x44, 0x8A, 0x92, 0x92, 0xA2, 0x44, 0x78, 0x80, 0x00, 0x00, 0x00}},
+    // U+00F9 Latin small letter u with grave
+    {0x00F9, {0x00, 0x20, 0x10, 0x00, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x86, 0x7A, 0x00, 0x00, 0x00, 0x00}},
+    // U+00FA Latin small letter u with acute
+    {0x00FA, {0x00, 0x08, 0x10, 0x00, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x86, 0x7A, 0x00, 0x00, 0x00, 0x00}},
+    // U+00FB Latin small letter u with circumflex
+    {0x00FB, {0x00, 0x10, 0x28, 0x00, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x86, 0x7A, 0x00, 0x00, 0x00, 0x00}},
+    // U+00FC Latin small letter u with diaeresis
+    {0x00FC, {0x00, 0x00, 0x44, 0x00, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x86, 0x7A, 0x00, 0x00, 0x00, 0x00}},
+    // U+00FD Latin small letter y with acute
+    {0x00FD, {0x00, 0x08, 0x10, 0x00, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x86, 0x7A, 0x02, 0x84, 0x78, 0x00}},
+    // U+00FF Latin small letter y with diaeresis
+    {0x00FF, {0x00, 0x00, 0x44, 0x00, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x86, 0x7A, 0x02, 0x84, 0x78, 0x00}},
+    // U+2013 En dash
+    {0x2013, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFE, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // U+2014 Em dash
+    {0x2014, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // U+2018 Left single quotation mark
+    {0x2018, {0x08, 0x10, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // U+2019 Right single quotation mark
+    {0x2019, {0x18, 0x08, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // U+201C Left double quotation mark
+    {0x201C, {0x24, 0x48, 0x6C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // U+201D Right double quotation mark
+    {0x201D, {0x6C, 0x24, 0x48, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // U+2022 Bullet
+    {0x2022, {0x00, 0x00, 0x00, 0x00, 0x38, 0x7C, 0x7C, 0x7C, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    // U+2026 Horizontal ellipsis
+    {0x2026, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xDB, 0xDB, 0x00, 0x00, 0x00, 0x00}},
+    // U+20AC Euro sign
+    {0x20AC, {0x1E, 0x21, 0x40, 0x40, 0xFC, 0x40, 0xFC, 0x40, 0x40, 0x40, 0x21, 0x1E, 0x00, 0x00, 0x00, 0x00}},
+    // U+FFFD Replacement character
+    {0xFFFD, {0xFE, 0x82, 0xBA, 0xAA, 0x8A, 0x9A, 0x92, 0x92, 0x82, 0x92, 0x82, 0xFE, 0x00, 0x00, 0x00, 0x00}}
+};
+
+static const int EXTRA_GLYPH_COUNT = sizeof(EXTRA_GLYPHS) / sizeof(EXTRA_GLYPHS[0]);
+static const int GLYPH_COUNT = ASCII_GLYPHS + EXTRA_GLYPH_COUNT;
+
+// Bitmap of glyph g: the ASCII table first, then the extra glyphs
+static constexpr const uint8_t* glyph_rows(int g) {
+    return g < ASCII_GLYPHS ? FONT_GLYPHS[g] : EXTRA_GLYPHS[g - ASCII_GLYPHS].rows;
+}
+
+// Ink box in font units, empty for blank glyphs, and the pen advance
+struct GlyphMetrics {
+    uint8_t left, top, width, height;
+    uint8_t advance;
+};
+
+// A glyph as the rects of its set bits, in font units: each row's runs,
+// merged down while the rows below repeat them. Drawing is one rect fill
+// per entry at any size, and blank glyphs have none.
+struct GlyphRect {
+    uint8_t x, y, w, h;
+};
+
+// A glyph row of 8 bits has at most 4 runs
+static const int MAX_GLYPH_RECTS = 16 * 4;
+
+static constexpr GlyphMetrics measure_glyph(const uint8_t* glyph) {
+    uint8_t bits = 0;
+    int top = 16, bottom = 0;
+    for (int row = 0; row < 16; row++) {
+        if (!glyph[row]) continue;
+        bits |= glyph[row];
+        if (row < top) top = row;
+        bottom = row + 1;
+    }
+    if (!bits) return GlyphMetrics{0, 0, 0, 0, GLYPH_ADVANCE};
     
-    // Initialize all to zero
-    for (int c = 0; c < 128; c++) {
-        for (int row = 0; row < 16; row++) {
-            g_font_glyphs[c][row] = 0x00;
+    int left = 0, right = 8;
+    while (!(bits & (0x80 >> left))) left++;
+    while (!(bits & (0x100 >> right))) right--;
+    return GlyphMetrics{(uint8_t)left, (uint8_t)top, (uint8_t)(right - left),
+                        (uint8_t)(bottom - top), GLYPH_ADVANCE};
+}
+
+// Only the rows and columns of the ink box are scanned
+static constexpr int build_glyph_rects(const uint8_t* glyph, GlyphRect* out) {
+    GlyphMetrics m = measure_glyph(glyph);
+    int count = 0;
+    int open[4] = {0, 0, 0, 0};   // Rects ending on the previous row
+    int openCount = 0;
+    
+    for (int row = m.top; row < m.top + m.height; row++) {
+        int next[4] = {0, 0, 0, 0};
+        int nextCount = 0;
+        uint8_t bits = glyph[row];
+        
+        int col = m.left;
+        while (col < m.left + m.width) {
+            if (!(bits & (0x80 >> col))) {
+                col++;
+                continue;
+            }
+            int start = col;
+            while (col < 8 && (bits & (0x80 >> col))) col++;
+            
+            int index = -1;
+            for (int k = 0; k < openCount; k++) {
+                if (out[open[k]].x == start && out[open[k]].w == col - start) {
+                    index = open[k];
+                    break;
+                }
+            }
+            if (index >= 0) {
+                out[index].h++;
+            } else {
+                index = count++;
+                out[index] = GlyphRect{(uint8_t)start, (uint8_t)row, (uint8_t)(col - start), 1};
+            }
+            next[nextCount++] = index;
         }
+        
+        for (int k = 0; k < nextCount; k++) open[k] = next[k];
+        openCount = nextCount;
     }
     
-    // Define all uppercase letters A-Z
-    uint8_t font_data[26][16] = {
-        // A (65)
-        {0x38, 0x44, 0x82, 0x82, 0x82, 0xFE, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00},
-        // B (66)
-        {0xFC, 0x82, 0x82, 0x82, 0xFC, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0xFC, 0x00, 0x00, 0x00, 0x00},
-        // C (67)
-        {0x3C, 0x42, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00},
-        // D (68)
-        {0xFC, 0x82, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x82, 0xFC, 0x00, 0x00, 0x00, 0x00},
-        // E (69)
-        {0xFE, 0x80, 0x80, 0x80, 0xFC, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xFE, 0x00, 0x00, 0x00, 0x00},
-        // F (70)
-        {0xFE, 0x80, 0x80, 0x80, 0xFC, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00},
-        // G (71)
-        {0x3C, 0x42, 0x80, 0x80, 0x80, 0x8E, 0x82, 0x82, 0x82, 0x82, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00},
-        // H (72)
-        {0x82, 0x82, 0x82, 0x82, 0xFE, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00},
-        // I (73)
-        {0x7C, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x7C, 0x00, 0x00, 0x00, 0x00},
-        // J (74)
-        {0x3E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x88, 0x88, 0x70, 0x00, 0x00, 0x00, 0x00},
-        // K (75)
-        {0x82, 0x84, 0x88, 0x90, 0xE0, 0x90, 0x88, 0x84, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00},
-        // L (76)
-        {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xFE, 0x00, 0x00, 0x00, 0x00},
-        // M (77)
-        {0x82, 0xC6, 0xAA, 0x92, 0x92, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00},
-        // N (78)
-        {0x82, 0xC2, 0xA2, 0x92, 0x8A, 0x86, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00},
-        // O (79)
-        {0x3C, 0x42, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00},
-        // P (80)
-        {0xFC, 0x82, 0x82, 0x82, 0xFC, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00},
-        // Q (81)
-        {0x3C, 0x42, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x89, 0x46, 0x3D, 0x00, 0x00, 0x00, 0x00},
-        // R (82)
-        {0xFC, 0x82, 0x82, 0x82, 0xFC, 0x90, 0x88, 0x84, 0x82, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00},
-        // S (83)
-        {0x3E, 0x41, 0x80, 0x80, 0x40, 0x3C, 0x02, 0x01, 0x01, 0x01, 0x82, 0x7C, 0x00, 0x00, 0x00, 0x00},
-        // T (84)
-        {0xFE, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00},
-        // U (85)
-        {0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00},
-        // V (86)
-        {0x82, 0x82, 0x82, 0x82, 0x44, 0x44, 0x44, 0x28, 0x28, 0x28, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00},
-        // W (87)
-        {0x82, 0x82, 0x82, 0x92, 0x92, 0x92, 0xAA, 0xAA, 0xAA, 0x44, 0x44, 0x44, 0x00, 0x00, 0x00, 0x00},
-        // X (88)
-        {0x82, 0x82, 0x44, 0x44, 0x28, 0x10, 0x28, 0x44, 0x44, 0x82, 0x82, 0x82, 0x00, 0x00, 0x00, 0x00},
-        // Y (89)
-        {0x82, 0x82, 0x44, 0x44, 0x28, 0x28, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00},
-        // Z (90)
-        {0xFE, 0x02, 0x04, 0x08, 0x10, 0x10, 0x20, 0x40, 0x80, 0x80, 0x80, 0xFE, 0x00, 0x00, 0x00, 0x00}
-    };
-    
-    // Copy to global storage (A-Z = ASCII 65-90)
-    for (int letter = 0; letter < 26; letter++) {
-        for (int row = 0; row < 16; row++) {
-            g_font_glyphs[65 + letter][row] = font_data[letter][row];
+    return count;
+}
+
+static constexpr int count_font_rects() {
+    GlyphRect scratch[MAX_GLYPH_RECTS] = {};
+    int total = 0;
+    for (int c = 0; c < GLYPH_COUNT; c++) total += build_glyph_rects(glyph_rows(c), scratch);
+    return total;
+}
+
+static const int FONT_RECT_COUNT = count_font_rects();
+
+struct FontTables {
+    GlyphMetrics metrics[GLYPH_COUNT];
+    uint16_t first[GLYPH_COUNT + 1];  // Glyph g owns rects [first[g], first[g + 1])
+    GlyphRect rects[FONT_RECT_COUNT];
+};
+
+static constexpr FontTables build_font_tables() {
+    FontTables tables = {};
+    int used = 0;
+    for (int c = 0; c < GLYPH_COUNT; c++) {
+        tables.metrics[c] = measure_glyph(glyph_rows(c));
+        tables.first[c] = (uint16_t)used;
+        used += build_glyph_rects(glyph_rows(c), tables.rects + used);
+    }
+    tables.first[GLYPH_COUNT] = (uint16_t)used;
+    return tables;
+}
+
+static constexpr FontTables g_font = build_font_tables();
+
+// Signed distance field of every glyph, one sample per font pixel center
+// with a margin around the cell: 128 on the outline, SDF_UNIT steps per
+// pixel, larger inside. It is computed from the bitmaps at compile time
+// and sampled with bilinear filtering for anti-aliased text at any scale.
+static const int SDF_MARGIN = 2;
+static const int SDF_WIDTH = 8 + 2 * SDF_MARGIN;
+static const int SDF_HEIGHT = 16 + 2 * SDF_MARGIN;
+static const int SDF_UNIT = 32;
+static const int SDF_RANGE = 2;     // Distances clamp at this many pixels
+
+template <int COUNT>
+struct FontSdf {
+    uint8_t glyphs[COUNT][SDF_HEIGHT][SDF_WIDTH];
+};
+
+// A glyph's rows widened to the SDF cell, ink bits from bit 0 at the left
+// of the margin, so the distance search needs no bounds checks
+struct SdfRows {
+    uint16_t bits[SDF_HEIGHT];
+};
+
+static constexpr SdfRows sdf_rows(const uint8_t* glyph) {
+    SdfRows rows = {};
+    for (int row = 0; row < 16; row++) {
+        for (int col = 0; col < 8; col++) {
+            if (glyph[row] & (0x80 >> col)) rows.bits[row + SDF_MARGIN] |= (uint16_t)(1 << (col + SDF_MARGIN));
+        }
+    }
+    return rows;
+}
+
+static constexpr int isqrt_const(int value) {
+    int root = 0;
+    while ((root + 1) * (root + 1) <= value) root++;
+    return root;
+}
+
+// Squared distances in half pixels only run up to (2 * SDF_RANGE)^2, so
+// their roots in SDF units are looked up
+static const int MAX_HALF_PIXEL_SQUARE = (2 * SDF_RANGE) * (2 * SDF_RANGE);
+
+struct SdfRoots {
+    uint8_t units[MAX_HALF_PIXEL_SQUARE + 1];
+};
+
+static constexpr SdfRoots build_sdf_roots() {
+    SdfRoots roots = {};
+    for (int k = 0; k <= MAX_HALF_PIXEL_SQUARE; k++) {
+        roots.units[k] = (uint8_t)isqrt_const(k * SDF_UNIT * SDF_UNIT / 4);
+    }
+    return roots;
+}
+
+static constexpr SdfRoots g_sdf_roots = build_sdf_roots();
+
+// Exact distance from the center of cell pixel col, row to the nearest
+// pixel of the other kind. Only pixels within SDF_RANGE are searched;
+// farther ones clamp anyway. Past the cell is empty, and the margin keeps
+// searches from ink pixels inside it.
+static constexpr uint8_t glyph_distance(const SdfRows& rows, int col, int row) {
+    bool inside = (rows.bits[row] >> col) & 1;
+    // Squared distance in half pixels; a square's edge is at least one away
+    int best = MAX_HALF_PIXEL_SQUARE;
+    for (int b = row - SDF_RANGE; b <= row + SDF_RANGE; b++) {
+        if (b < 0 || b >= SDF_HEIGHT) continue;
+        uint32_t other = inside ? ~(uint32_t)rows.bits[b] : rows.bits[b];
+        for (int a = col - SDF_RANGE; a <= col + SDF_RANGE; a++) {
+            if (a < 0 || a >= SDF_WIDTH || !((other >> a) & 1)) continue;
+            int dx = a > col ? 2 * (a - col) - 1 : (a < col ? 2 * (col - a) - 1 : 0);
+            int dy = b > row ? 2 * (b - row) - 1 : (b < row ? 2 * (row - b) - 1 : 0);
+            if (dx * dx + dy * dy < best) best = dx * dx + dy * dy;
+        }
+    }
+    int distance = g_sdf_roots.units[best];
+    return (uint8_t)(inside ? 128 + distance : 128 - distance);
+}
+
+template <int FIRST, int COUNT>
+static constexpr FontSdf<COUNT> build_font_sdf() {
+    FontSdf<COUNT> sdf = {};
+    for (int c = 0; c < COUNT; c++) {
+        SdfRows rows = sdf_rows(glyph_rows(FIRST + c));
+        for (int row = 0; row < SDF_HEIGHT; row++) {
+            for (int col = 0; col < SDF_WIDTH; col++) {
+                sdf.glyphs[c][row][col] = glyph_distance(rows, col, row);
+            }
         }
     }
+    return sdf;
+}
+
+// ASCII and the extra glyphs are built apart to stay within the compiler's
+// constant evaluation limit
+static constexpr FontSdf<ASCII_GLYPHS> g_ascii_sdf = build_font_sdf<0, ASCII_GLYPHS>();
+static constexpr FontSdf<EXTRA_GLYPH_COUNT> g_extra_sdf =
+    build_font_sdf<ASCII_GLYPHS, EXTRA_GLYPH_COUNT>();
+
+static const uint8_t (*glyph_sdf(int glyph))[SDF_WIDTH] {
+    return glyph < ASCII_GLYPHS ? g_ascii_sdf.glyphs[glyph] : g_extra_sdf.glyphs[glyph - ASCII_GLYPHS];
+}
+
+// Two-level map from BMP code points to glyphs: the high byte picks a
+// page and the low byte the glyph in it. Only pages holding glyphs are
+// stored, so the whole map is a few KB.
+static constexpr int count_glyph_pages() {
+    int pages = 0;
+    for (int k = 0; k < EXTRA_GLYPH_COUNT; k++) {
+        bool seen = false;
+        for (int j = 0; j < k; j++) {
+            if (EXTRA_GLYPHS[j].codePoint >> 8 == EXTRA_GLYPHS[k].codePoint >> 8) seen = true;
+        }
+        if (!seen) pages++;
+    }
+    return pages;
+}
+
+static const int GLYPH_PAGE_COUNT = count_glyph_pages();
+
+struct GlyphPages {
+    uint8_t slot[256];                          // Page slot + 1, 0 for none
+    uint16_t glyphs[GLYPH_PAGE_COUNT][256];     // Glyph + 1, 0 for none
+};
+
+static constexpr GlyphPages build_glyph_pages() {
+    GlyphPages pages = {};
+    int used = 0;
+    for (int k = 0; k < EXTRA_GLYPH_COUNT; k++) {
+        uint32_t codePoint = EXTRA_GLYPHS[k].codePoint;
+        int page = (int)(codePoint >> 8);
+        if (!pages.slot[page]) pages.slot[page] = (uint8_t)++used;
+        pages.glyphs[pages.slot[page] - 1][codePoint & 255] = (uint16_t)(ASCII_GLYPHS + k + 1);
+    }
+    return pages;
+}
+
+static constexpr GlyphPages g_glyph_pages = build_glyph_pages();
+
+static constexpr int find_glyph(uint32_t codePoint) {
+    for (int k = 0; k < EXTRA_GLYPH_COUNT; k++) {
+        if (EXTRA_GLYPHS[k].codePoint == codePoint) return ASCII_GLYPHS + k;
+    }
+    return -1;
+}
+
+static const int REPLACEMENT_GLYPH = find_glyph(0xFFFD);
+
+static inline int glyph_for_code_point(uint32_t codePoint) {
+    if (codePoint < 0x10000) {
+        int slot = g_glyph_pages.slot[codePoint >> 8];
+        if (slot) {
+            int glyph = g_glyph_pages.glyphs[slot - 1][codePoint & 255];
+            if (glyph) return glyph - 1;
+        }
+    }
+    return REPLACEMENT_GLYPH;
+}
+
+// Rest of the UTF-8 sequence started by lead, moving text past it.
+// Malformed input gives U+FFFD for the longest valid start of a sequence,
+// so decoding resumes at the byte that broke it, as browsers do.
+static uint32_t decode_utf8(unsigned char lead, const char*& text) {
+    int extra;
+    uint32_t codePoint;
+    // Range of the second byte, which rules out overlong forms, surrogates
+    // and code points past U+10FFFF
+    unsigned char low = 0x80, high = 0xBF;
+    if (lead < 0xC2) {
+        return 0xFFFD;
+    } else if (lead < 0xE0) {
+        extra = 1;
+        codePoint = lead & 0x1F;
+    } else if (lead < 0xF0) {
+        extra = 2;
+        codePoint = lead & 0x0F;
+        if (lead == 0xE0) low = 0xA0;
+        if (lead == 0xED) high = 0x9F;
+    } else if (lead <= 0xF4) {
+        extra = 3;
+        codePoint = lead & 0x07;
+        if (lead == 0xF0) low = 0x90;
+        if (lead == 0xF4) high = 0x8F;
+    } else {
+        return 0xFFFD;
+    }
     
-    // Numbers 0-9 (ASCII 48-57)
-    uint8_t num_0[] = {0x3C, 0x42, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00};
-    uint8_t num_3[] = {0x3C, 0x42, 0x01, 0x01, 0x02, 0x1C, 0x02, 0x01, 0x01, 0x01, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00};
+    for (int k = 0; k < extra; k++) {
+        unsigned char next = (unsigned char)*text;
+        if (next < low || next > high) return 0xFFFD;
+        codePoint = (codePoint << 6) | (next & 0x3F);
+        text++;
+        low = 0x80;
+        high = 0xBF;
+    }
+    return codePoint;
+}
+
+// Glyph of the next character, moving text past it; -1 for ASCII control
+// characters, which are blank cells. ASCII is one compare and no lookup.
+static inline int next_glyph(const char*& text) {
+    unsigned char c = (unsigned char)*text++;
+    if (c < 128) return c >= FIRST_GLYPH && c < FIRST_GLYPH + ASCII_GLYPHS ? c - FIRST_GLYPH : -1;
+    return glyph_for_code_point(decode_utf8(c, text));
+}
+
+static inline int glyph_advance(int glyph) {
+    return glyph >= 0 ? g_font.metrics[glyph].advance : GLYPH_ADVANCE;
+}
+
+static int text_width(const char* text, int size) {
+    int width = 0;
+    while (*text != '\0') width += glyph_advance(next_glyph(text));
+    return width * size;
+}
+
+// Strings redrawn every frame are laid out once per size: an entry holds
+// the run's pixel rects relative to its origin, ready to fill, and its
+// width for measureText. UTF-8 is decoded only at layout; a hit compares
+// bytes. Color is applied when filling, so it is not part of the key.
+// Longer strings, and runs with more rects than a slot holds, are drawn
+// glyph by glyph.
+static const int TEXT_CACHE_SLOTS = 16;
+static const int MAX_RUN_LENGTH = 63;     // Bytes
+static const int MAX_RUN_RECTS = 512;
+
+struct RunRect {
+    int16_t x, y, w, h;
+};
+
+struct TextRun {
+    bool used;
+    uint32_t hash;
+    int size;
+    int length;
+    int width;
+    int inkTop, inkHeight;    // Rows holding ink, relative to the origin
+    int rectCount;        // -1 when the rects did not fit
+    uint32_t lastUse;
+    char text[MAX_RUN_LENGTH + 1];
+    RunRect* rects;       // MAX_RUN_RECTS, kept across evictions
+};
+
+static TextRun s_runCache[TEXT_CACHE_SLOTS];
+static uint32_t s_runClock = 0;
+
+// FNV-1a of the string, and its length
+static uint32_t hash_text(const char* text, int* length) {
+    uint32_t hash = 2166136261u;
+    int len = 0;
+    while (text[len] != '\0') {
+        hash = (hash ^ (uint8_t)text[len]) * 16777619u;
+        len++;
+    }
+    *length = len;
+    return hash;
+}
+
+static void layout_run(TextRun& run, const char* text, int size) {
+    run.rectCount = 0;
+    int currentX = 0;
+    int inkTop = 16, inkBottom = 0;
     
-    for (int i = 0; i < 16; i++) {
-        g_font_glyphs['0'][i] = num_0[i];
-        g_font_glyphs['3'][i] = num_3[i];
+    while (*text != '\0') {
+        int index = next_glyph(text);
+        if (index >= 0 && g_font.metrics[index].height > 0) {
+            const GlyphMetrics& m = g_font.metrics[index];
+            if (m.top < inkTop) inkTop = m.top;
+            if (m.top + m.height > inkBottom) inkBottom = m.top + m.height;
+            
+            for (int k = g_font.first[index]; k < g_font.first[index + 1] && run.rectCount >= 0; k++) {
+                if (run.rectCount == MAX_RUN_RECTS) {
+                    run.rectCount = -1;
+                    break;
+                }
+                const GlyphRect& r = g_font.rects[k];
+                run.rects[run.rectCount++] = RunRect{(int16_t)(currentX + r.x * size), (int16_t)(r.y * size),
+                                                     (int16_t)(r.w * size), (int16_t)(r.h * size)};
+            }
+        }
+        
+        currentX += glyph_advance(index) * size;
     }
     
-    // Space (32)
-    // Already all zeros
+    run.width = currentX;
+    run.inkTop = inkTop < inkBottom ? inkTop * size : 0;
+    run.inkHeight = inkTop < inkBottom ? (inkBottom - inkTop) * size : 0;
+}
+
+// Entry for (text, size), laid out into the least recently used slot on
+// a miss; nullptr for strings that are not cached
+static const TextRun* find_run(const char* text, int size) {
+    int length;
+    uint32_t hash = hash_text(text, &length);
+    // Pixel rects are 16-bit
+    if (length == 0 || length > MAX_RUN_LENGTH || size <= 0 ||
+        length * GLYPH_ADVANCE * size > 32767 || 16 * size > 32767) return nullptr;
     
-    g_font_initialized = true;
+    TextRun* victim = &s_runCache[0];
+    for (int i = 0; i < TEXT_CACHE_SLOTS; i++) {
+        TextRun& slot = s_runCache[i];
+        if (slot.used && slot.hash == hash && slot.size == size && slot.length == length) {
+            int k = 0;
+            while (k < length && slot.text[k] == text[k]) k++;
+            if (k == length) {
+                slot.lastUse = ++s_runClock;
+                return &slot;
+            }
+        }
+        if (!slot.used || (victim->used && slot.lastUse < victim->lastUse)) victim = &slot;
+    }
+    
+    if (!victim->rects) {
+        victim->rects = new RunRect[MAX_RUN_RECTS];
+        if (!victim->rects) return nullptr;
+    }
+    
+    victim->used = true;
+    victim->hash = hash;
+    victim->size = size;
+    victim->length = length;
+    victim->lastUse = ++s_runClock;
+    for (int k = 0; k <= length; k++) victim->text[k] = text[k];
+    layout_run(*victim, text, size);
+    return victim;
 }
 
-// Empty declaration for compatibility
-const uint8_t FontRenderer::FONT_DATA[][16] = {{0}};
+// Anti-aliased glyph coverage per scale. A glyph is rasterized from the
+// distance field the first time it is drawn at a scale, so text at a
+// cached scale only blends stored rows. Scales are reused least recently
+// used first. Masks are carved from one fixed pool on first use; when it
+// is full every mask is dropped and the pool is refilled from the start,
+// so memory stays bounded however many scales are drawn.
+static const int SMOOTH_CACHE_SLOTS = 4;
+static const uint32_t MASK_POOL_BYTES = 128 * 1024;   // 14 glyphs at 8x
+
+// Mask rows are stored as the first covered column and the count of
+// columns through the last covered one, then w coverage bytes, so blank
+// ends are never blended
+static const int MASK_ROW_HEADER = 2;
 
-FontRenderer::FontRenderer(Renderer& renderer) : m_renderer(renderer) {
-    init_font_data();
+struct GlyphMask {
+    int16_t x, y, w, h;   // Pixel box relative to the pen, ink box plus one pixel
+    uint32_t offset;      // Into the mask pool
+    uint32_t generation;  // Pool generation it was rasterized in, 0 for none
+};
+
+struct SmoothSize {
+    bool used;
+    int scale;
+    uint32_t lastUse;
+    GlyphMask glyphs[GLYPH_COUNT];
+};
+
+static SmoothSize s_smoothCache[SMOOTH_CACHE_SLOTS];
+static uint32_t s_smoothClock = 0;
+static uint8_t* s_maskPool = nullptr;
+static uint32_t s_maskPoolUsed = 0;
+static uint32_t s_maskGeneration = 1;     // Bumped each time the pool is refilled
+
+static inline int floor_div(int value, int divisor) {
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
 }
 
-void FontRenderer::drawText(int x, int y, const char* text, Renderer::Color color, int size) {
-    int currentX = x;
+// Bilinear distance at u, v (font pixels, 8.8 fixed point) turned into
+// coverage of a pixel 256 / scale font pixels wide
+static uint8_t sample_coverage(const uint8_t (*sdf)[SDF_WIDTH], int u, int v, int scale) {
+    int gx = u - 128 + SDF_MARGIN * 256;
+    int gy = v - 128 + SDF_MARGIN * 256;
+    if (gx < 0) gx = 0;
+    if (gy < 0) gy = 0;
+    if (gx > (SDF_WIDTH - 1) * 256) gx = (SDF_WIDTH - 1) * 256;
+    if (gy > (SDF_HEIGHT - 1) * 256) gy = (SDF_HEIGHT - 1) * 256;
     
-    for (int i = 0; text[i] != '\0'; i++) {
-        unsigned char c = (unsigned char)text[i];
-        if (c >= 128) continue;
-        
-        const uint8_t* glyph = g_font_glyphs[c];
-        
-        // Check if glyph is empty (all zeros) - if so, just skip it
-        bool isEmpty = true;
-        for (int row = 0; row < 16; row++) {
-            if (glyph[row] != 0) {
-                isEmpty = false;
-                break;
+    int ix = gx >> 8, fx = gx & 255;
+    int iy = gy >> 8, fy = gy & 255;
+    int ix1 = ix + 1 < SDF_WIDTH ? ix + 1 : ix;
+    int iy1 = iy + 1 < SDF_HEIGHT ? iy + 1 : iy;
+    int top = sdf[iy][ix] * (256 - fx) + sdf[iy][ix1] * fx;
+    int bottom = sdf[iy1][ix] * (256 - fx) + sdf[iy1][ix1] * fx;
+    int distance = (top * (256 - fy) + bottom * fy) - 128 * 65536;
+    
+    // 0.5 + distance in output pixels, in 255ths, rounded down so a pixel
+    // half a pixel outside the outline gets none
+    int64_t num = (int64_t)distance * scale * 255;
+    int64_t den = (int64_t)SDF_UNIT * 65536 * 256;
+    int64_t coverage = num / den;
+    if (num % den != 0 && num < 0) coverage--;
+    coverage += 128;
+    if (coverage < 0) return 0;
+    if (coverage > 255) return 255;
+    return (uint8_t)coverage;
+}
+
+static void rasterize_glyph(SmoothSize& slot, int index) {
+    const GlyphMetrics& m = g_font.metrics[index];
+    GlyphMask& mask = slot.glyphs[index];
+    int scale = slot.scale;
+    int x0 = floor_div(m.left * scale, 256) - 1;
+    int y0 = floor_div(m.top * scale, 256) - 1;
+    int x1 = ((m.left + m.width) * scale + 255) / 256 + 1;
+    int y1 = ((m.top + m.height) * scale + 255) / 256 + 1;
+    mask.x = (int16_t)x0;
+    mask.y = (int16_t)y0;
+    mask.w = (int16_t)(x1 - x0);
+    mask.h = (int16_t)(y1 - y0);
+    
+    // A glyph at MAX_SMOOTH_SCALE is under 9 KB, so an emptied pool always
+    // has room
+    uint32_t bytes = (uint32_t)((MASK_ROW_HEADER + mask.w) * mask.h);
+    if (s_maskPoolUsed + bytes > MASK_POOL_BYTES) {
+        s_maskGeneration++;
+        s_maskPoolUsed = 0;
+    }
+    mask.offset = s_maskPoolUsed;
+    mask.generation = s_maskGeneration;
+    s_maskPoolUsed += bytes;
+    
+    const uint8_t (*sdf)[SDF_WIDTH] = glyph_sdf(index);
+    uint8_t* out = s_maskPool + mask.offset;
+    
+    // Pixel centers in 8.8 font pixels: (p + 0.5) * 256 / scale * 256
+    for (int row = 0; row < mask.h; row++, out += MASK_ROW_HEADER + mask.w) {
+        int v = (int)(((int64_t)(2 * (mask.y + row) + 1) * 65536) / (2 * scale));
+        uint8_t* coverage = out + MASK_ROW_HEADER;
+        int first = mask.w, last = 0;
+        for (int col = 0; col < mask.w; col++) {
+            int u = (int)(((int64_t)(2 * (mask.x + col) + 1) * 65536) / (2 * scale));
+            coverage[col] = sample_coverage(sdf, u, v, scale);
+            if (coverage[col]) {
+                if (col < first) first = col;
+                last = col + 1;
             }
         }
+        out[0] = (uint8_t)(first < last ? first : 0);
+        out[1] = (uint8_t)(first < last ? last - first : 0);
+    }
+}
+
+// Slot for scale, emptied on a miss; nullptr if the mask pool cannot be
+// allocated
+static SmoothSize* smooth_size(int scale) {
+    if (!s_maskPool) {
+        s_maskPool = new uint8_t[MASK_POOL_BYTES];
+        if (!s_maskPool) return nullptr;
+    }
+    
+    SmoothSize* victim = &s_smoothCache[0];
+    for (int i = 0; i < SMOOTH_CACHE_SLOTS; i++) {
+        SmoothSize& slot = s_smoothCache[i];
+        if (slot.used && slot.scale == scale) {
+            slot.lastUse = ++s_smoothClock;
+            return &slot;
+        }
+        if (!slot.used || (victim->used && slot.lastUse < victim->lastUse)) victim = &slot;
+    }
+    
+    // The old scale's masks stay in the pool until it is next refilled
+    for (int c = 0; c < GLYPH_COUNT; c++) victim->glyphs[c].generation = 0;
+    victim->used = true;
+    victim->scale = scale;
+    victim->lastUse = ++s_smoothClock;
+    return victim;
+}
+
+FontRenderer::FontRenderer(Renderer& renderer) : m_renderer(renderer) {}
+
+void FontRenderer::invalidateCache() {
+    for (int i = 0; i < TEXT_CACHE_SLOTS; i++) s_runCache[i].used = false;
+}
+
+void FontRenderer::drawText(int x, int y, const char* text, Renderer::Color color, int size) {
+    const TextRun* run = find_run(text, size);
+    if (run && run->rectCount >= 0) {
+        if (m_renderer.clipBounds(x, y + run->inkTop, run->width, run->inkHeight).w == 0) return;
         
-        if (!isEmpty) {
-            for (int row = 0; row < 16; row++) {
-                uint8_t byte = glyph[row];
-                for (int col = 0; col < 8; col++) {
-                    if (byte & (0x80 >> col)) {
-                        for (int sy = 0; sy < size; sy++) {
-                            for (int sx = 0; sx < size; sx++) {
-                                m_renderer.drawPixel(currentX + col * size + sx, 
-                                                    y + row * size + sy, color);
-                            }
-                        }
-                    }
-                }
+        // Set bits never overlap, so translucent text blends each pixel once
+        for (int k = 0; k < run->rectCount; k++) {
+            const RunRect& r = run->rects[k];
+            m_renderer.drawFilledRectangle(x + r.x, y + r.y, r.w, r.h, color);
+        }
+        return;
+    }
+    
+    int currentX = x;
+    
+    while (*text != '\0') {
+        int index = next_glyph(text);
+        
+        if (index >= 0) {
+            for (int k = g_font.first[index]; k < g_font.first[index + 1]; k++) {
+                const GlyphRect& r = g_font.rects[k];
+                m_renderer.drawFilledRectangle(currentX + r.x * size, y + r.y * size,
+                                               r.w * size, r.h * size, color);
             }
         }
         
-        currentX += 8 * size + 2 * size; // Character width + spacing
+        currentX += glyph_advance(index) * size;
     }
 }
 
@@ -143,8 +992,57 @@ void FontRenderer::drawTextCentered(int y, const char* text, Renderer::Color col
     drawText(x, y, text, color, size);
 }
 
+void FontRenderer::drawSmoothText(int x, int y, const char* text, Renderer::Color color, int scale) {
+    SmoothSize* slot = nullptr;
+    if (scale >= MIN_SMOOTH_SCALE && scale <= MAX_SMOOTH_SCALE) slot = smooth_size(scale);
+    if (!slot) {
+        int size = (scale + SCALE_ONE / 2) / SCALE_ONE;
+        drawText(x, y, text, color, size > 0 ? size : 1);
+        return;
+    }
+    
+    // The pen advances in 8.8 fixed point; glyphs start at its nearest pixel
+    int pen = 0;
+    while (*text != '\0') {
+        int index = next_glyph(text);
+        
+        if (index >= 0 && g_font.metrics[index].height > 0) {
+            GlyphMask& mask = slot->glyphs[index];
+            if (mask.generation != s_maskGeneration) rasterize_glyph(*slot, index);
+            
+            int gx = x + (pen + 128) / 256 + mask.x;
+            int gy = y + mask.y;
+            const uint8_t* line = s_maskPool + mask.offset;
+            for (int row = 0; row < mask.h; row++, line += MASK_ROW_HEADER + mask.w) {
+                if (line[1] == 0) continue;
+                m_renderer.blendRow(gx + line[0], gy + row, line[1], color,
+                                    line + MASK_ROW_HEADER + line[0]);
+            }
+        }
+        
+        pen += glyph_advance(index) * scale;
+    }
+}
+
+void FontRenderer::drawSmoothTextCentered(int y, const char* text, Renderer::Color color, int scale) {
+    int width = measureSmoothText(text, scale);
+    int x = (m_renderer.width() - width) / 2;
+    drawSmoothText(x, y, text, color, scale);
+}
+
+int FontRenderer::measureSmoothText(const char* text, int scale) {
+    // The run at size 1 holds the advance in font pixels
+    const TextRun* run = find_run(text, 1);
+    int advance = run ? run->width : text_width(text, 1);
+    return (advance * scale + 128) / 256;
+}
+
+void FontRenderer::present() {
+    m_renderer.present();
+}
+
 int FontRenderer::measureText(const char* text, int size) {
-    int len = 0;
-    while (text[len] != '\0') len++;
-    return len * (8 * size + 2 * size);
+    const TextRun* run = find_run(text, size);
+    if (run) return run->width;
+    return text_width(text, size);
 }
@@ -7,17 +7,32 @@ class FontRenderer {
 public:
     FontRenderer(Renderer& renderer);
     
+    // Text is UTF-8; characters the font lacks show as U+FFFD
     void drawText(int x, int y, const char* text, Renderer::Color color, int size = 1);
     void drawTextCentered(int y, const char* text, Renderer::Color color, int size = 1);
     void present(); 
     
     int measureText(const char* text, int size = 1);
+    
+    // Anti-aliased text sampled from a distance field atlas at any scale,
+    // in 8.8 fixed point (SCALE_ONE draws the 8x16 cell as is). Coverage
+    // is cached per scale, so repeated sizes only blend stored rows.
+    // Scales outside MIN..MAX_SMOOTH_SCALE fall back to drawText.
+    static const int SCALE_ONE = 256;
+    static const int MIN_SMOOTH_SCALE = SCALE_ONE / 2;
+    static const int MAX_SMOOTH_SCALE = 8 * SCALE_ONE;
+    
+    void drawSmoothText(int x, int y, const char* text, Renderer::Color color, int scale);
+    void drawSmoothTextCentered(int y, const char* text, Renderer::Color color, int scale);
+    int measureSmoothText(const char* text, int scale);
+    
+    // Strings are laid out once per size and reused until evicted. Hits
+    // compare the bytes, so editing a string in place never reuses a stale
+    // run; this only drops every cached run, as when timing cold layout.
+    static void invalidateCache();
 
 private:
     Renderer& m_renderer;
-    
-    // Embedded font data will be initialized at runtime
-    static const uint8_t FONT_DATA[][16];
 };
 
 #endif // FONT_RENDERER_H
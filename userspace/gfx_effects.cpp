@@ -1,4 +1,14 @@
 #include "gfx_effects.h"
+#include "pixel_kernels.h"
+#include "pixel_ops.h"
+#include "surface.h"
+#include "memory.h"
+#include "aa_coverage.h"
+#include <cstring>
+
+// Per-pixel alpha is staged in chunks of this many pixels and handed to
+// Renderer::blendRow
+static const int SPAN_CHUNK = 256;
 
 // Integer-only sqrt (no floats needed)
 static int isqrt(int x) {
@@ -12,6 +22,174 @@ static int isqrt(int x) {
     return guess;
 }
 
+// ============================================================
+// BLUR
+// ============================================================
+
+// Scratch for the blur, allocated once since the heap never frees: two
+// line buffers for the horizontal passes, then a block for the vertical
+// passes, which run over strips of columns as tall as the area. Areas
+// wider than BLUR_MAX_WIDTH are left unblurred.
+static const int BLUR_SCRATCH_PIXELS = 256 * 1024;    // 1 MB
+static const int BLUR_MAX_WIDTH = 8192;
+static const int BLUR_MAX_STRIP = 512;                // Columns per vertical strip
+static uint32_t* s_blurScratch = nullptr;
+static uint64_t* s_blurSums = nullptr;
+
+// Window sums keep all three channels in one word, 21 bits each, so a
+// window step is one add and one subtract. A window of up to 511 pixels
+// sums to at most 130305 per channel, well within a field.
+static inline uint64_t spread(uint32_t p) {
+    return (p & 0xFF) | ((uint64_t)(p & 0xFF00) << 13) | ((uint64_t)(p & 0xFF0000) << 26);
+}
+
+// Box average of each field: sum * (2^24 / w) >> 24, which stays within
+// 32 bits for sum <= 255 * w
+static inline uint32_t boxPixel(uint64_t sum, uint32_t mul) {
+    uint32_t b = (uint32_t)sum & 0x1FFFFF;
+    uint32_t g = (uint32_t)(sum >> 21) & 0x1FFFFF;
+    uint32_t r = (uint32_t)(sum >> 42);
+    return (((r * mul + (1u << 23)) >> 24) << 16) |
+           (((g * mul + (1u << 23)) >> 24) << 8) |
+           ((b * mul + (1u << 23)) >> 24);
+}
+
+// One sliding-window box pass along a line of n pixels, edges clamped.
+// The clamped ends are split off so the middle loop reads straight.
+static void boxBlurLine(const uint32_t* src, uint32_t* dst, int n, int radius) {
+    uint32_t mul = (1u << 24) / (2 * radius + 1);
+    uint64_t sum = spread(src[0]) * (radius + 1);
+    for (int k = 1; k <= radius; k++) {
+        sum += spread(src[k < n ? k : n - 1]);
+    }
+    
+    // Before head the window's left end is clamped to 0, from tail on
+    // its right end is clamped to n - 1
+    int head = radius + 1 < n ? radius + 1 : n;
+    int tail = n - radius - 1 > head ? n - radius - 1 : head;
+    int i = 0;
+    for (; i < head; i++) {
+        dst[i] = boxPixel(sum, mul);
+        int in = i + radius + 1;
+        sum += spread(src[in < n ? in : n - 1]);
+        sum -= spread(src[0]);
+    }
+    for (; i < tail; i++) {
+        dst[i] = boxPixel(sum, mul);
+        sum += spread(src[i + radius + 1]);
+        sum -= spread(src[i - radius]);
+    }
+    for (; i < n; i++) {
+        dst[i] = boxPixel(sum, mul);
+        int out = i - radius;
+        sum += spread(src[n - 1]);
+        sum -= spread(src[out > 0 ? out : 0]);
+    }
+}
+
+// The same pass down every column of a w x h block at once. Rows are read
+// in order with one running sum per column, so memory is walked row-wise.
+static void boxBlurColumns(const uint32_t* src, int srcPitch, uint32_t* dst, int dstPitch,
+                           int w, int h, int radius, uint64_t* sums) {
+    uint32_t mul = (1u << 24) / (2 * radius + 1);
+    
+    for (int x = 0; x < w; x++) {
+        sums[x] = spread(src[x]) * (radius + 1);
+    }
+    for (int k = 1; k <= radius; k++) {
+        const uint32_t* row = src + (k < h ? k : h - 1) * srcPitch;
+        for (int x = 0; x < w; x++) {
+            sums[x] += spread(row[x]);
+        }
+    }
+    
+    for (int y = 0; y < h; y++) {
+        uint32_t* out = dst + y * dstPitch;
+        for (int x = 0; x < w; x++) {
+            out[x] = boxPixel(sums[x], mul);
+        }
+        
+        int in = y + radius + 1;
+        int gone = y - radius;
+        const uint32_t* addRow = src + (in < h ? in : h - 1) * srcPitch;
+        const uint32_t* subRow = src + (gone > 0 ? gone : 0) * srcPitch;
+        for (int x = 0; x < w; x++) {
+            sums[x] += spread(addRow[x]);
+            sums[x] -= spread(subRow[x]);
+        }
+    }
+}
+
+// Three box passes per axis approximate a Gaussian. The pass radii add up
+// to radius, so the blur reaches radius pixels, and the cost per pixel is
+// the same for any radius. Pixels outside the clipped area are never
+// read; edges are clamped.
+void GfxEffects::blur(Renderer& renderer, int x, int y, int width, int height, int radius) {
+    if (radius <= 0) return;
+    if (radius > 255) radius = 255;
+    
+    Renderer::Rect area = renderer.markDamage(x, y, width, height);
+    if (area.w == 0) return;
+    
+    int w = area.w, h = area.h;
+    int passes[3] = {radius / 3, (radius + 1) / 3, (radius + 2) / 3};
+    if (w > BLUR_MAX_WIDTH) return;
+    
+    // A failed new takes nothing from the heap, so retrying is free
+    if (!s_blurScratch) s_blurScratch = new uint32_t[BLUR_SCRATCH_PIXELS];
+    if (!s_blurSums) s_blurSums = new uint64_t[BLUR_MAX_STRIP];
+    if (!s_blurScratch || !s_blurSums) return;
+    uint32_t* lineA = s_blurScratch;
+    uint32_t* lineB = lineA + BLUR_MAX_WIDTH;
+    uint32_t* block = lineB + BLUR_MAX_WIDTH;
+    int strip = (BLUR_SCRATCH_PIXELS - 2 * BLUR_MAX_WIDTH) / h;
+    if (strip > BLUR_MAX_STRIP) strip = BLUR_MAX_STRIP;
+    if (strip == 0) return;
+    
+    uint32_t* target = renderer.targetRow(area.y) + area.x;
+    int pitch = renderer.targetPitch();
+    
+    // Horizontal: each row is blurred three times while it is in cache
+    // and written back in place
+    for (int py = 0; py < h; py++) {
+        uint32_t* src = lineA;
+        uint32_t* dst = lineB;
+        PixelKernels::copy(src, target + py * pitch, w);
+        for (int p = 0; p < 3; p++) {
+            if (passes[p] == 0) continue;
+            boxBlurLine(src, dst, w, passes[p]);
+            uint32_t* done = dst;
+            dst = src;
+            src = done;
+        }
+        PixelKernels::copy(target + py * pitch, src, w);
+    }
+    
+    // Vertical: each strip of columns ping-pongs between the target and
+    // the block; columns do not depend on each other
+    for (int sx = 0; sx < w; sx += strip) {
+        int sw = w - sx < strip ? w - sx : strip;
+        uint32_t* columns = target + sx;
+        bool inBlock = false;
+        for (int p = 0; p < 3; p++) {
+            if (passes[p] == 0) continue;
+            if (inBlock) {
+                boxBlurColumns(block, sw, columns, pitch, sw, h, passes[p], s_blurSums);
+            } else {
+                boxBlurColumns(columns, pitch, block, sw, sw, h, passes[p], s_blurSums);
+            }
+            inBlock = !inBlock;
+        }
+        
+        if (inBlock) {
+            // An odd number of vertical passes left the result in the block
+            for (int py = 0; py < h; py++) {
+                PixelKernels::copy(columns + py * pitch, block + py * sw, sw);
+            }
+        }
+    }
+}
+
 uint8_t GfxEffects::smoothstep(float edge0, float edge1, float x) {
     float t = (x - edge0) / (edge1 - edge0);
     if (t < 0.0f) t = 0.0f;
@@ -20,98 +198,1366 @@ uint8_t GfxEffects::smoothstep(float edge0, float edge1, float x) {
     return (uint8_t)(t * 255.0f);
 }
 
+// ============================================================
+// SHADOW CACHE
+// ============================================================
+
+// A shadow's alpha only depends on the distance to the rect, so one
+// quadrant of (blur + 1) x (blur + 1) values describes any size. Rows
+// are stored as the left edge (distance blur..1) followed by the right
+// edge (1..blur), ready to hand to blendRow, plus the alpha between them.
+static const int SHADOW_CACHE_SLOTS = 8;
+static const int SHADOW_MAX_BLUR = 64;
+
+struct ShadowSlice {
+    int blur;
+    int alpha;
+    uint32_t lastUse;
+    uint8_t* edges;           // (blur + 1) rows of 2 * blur
+    uint8_t middle[SHADOW_MAX_BLUR + 1];
+};
+
+static ShadowSlice s_shadowCache[SHADOW_CACHE_SLOTS];
+static uint32_t s_shadowClock = 0;
+
+static inline uint8_t shadowAlpha(int distX, int distY, int blur, int alpha) {
+    int dist = isqrt(distX * distX + distY * distY);
+    return dist < blur ? (uint8_t)(((blur - dist) * alpha) / blur) : 0;
+}
+
+// Slices for (blur, alpha), rasterized into the least recently used slot
+// on a miss. Color is applied when blending, so it is not part of the key.
+static const ShadowSlice* shadowSlices(int blur, int alpha) {
+    ShadowSlice* victim = &s_shadowCache[0];
+    for (int i = 0; i < SHADOW_CACHE_SLOTS; i++) {
+        ShadowSlice& slot = s_shadowCache[i];
+        if (slot.edges && slot.blur == blur && slot.alpha == alpha) {
+            slot.lastUse = ++s_shadowClock;
+            return &slot;
+        }
+        if (!slot.edges || (victim->edges && slot.lastUse < victim->lastUse)) victim = &slot;
+    }
+    
+    if (!victim->edges) {
+        victim->edges = new uint8_t[(SHADOW_MAX_BLUR + 1) * 2 * SHADOW_MAX_BLUR];
+        if (!victim->edges) return nullptr;
+    }
+    
+    victim->blur = blur;
+    victim->alpha = alpha;
+    victim->lastUse = ++s_shadowClock;
+    for (int distY = 0; distY <= blur; distY++) {
+        uint8_t* row = victim->edges + distY * 2 * blur;
+        for (int k = 0; k < blur; k++) {
+            row[k] = shadowAlpha(blur - k, distY, blur, alpha);
+            row[blur + k] = shadowAlpha(k + 1, distY, blur, alpha);
+        }
+        victim->middle[distY] = shadowAlpha(0, distY, blur, alpha);
+    }
+    return victim;
+}
+
+// Nine-slice assembly: every row is a cached left edge, one constant-alpha
+// span and a cached right edge, so the cost is one blend per pixel with
+// no distance math once the slices exist
 void GfxEffects::dropShadow(Renderer& renderer, int x, int y, int width, int height,
                             int offsetX, int offsetY, int blur, Renderer::Color color) {
-    // Simple drop shadow implementation (integer-only)
-    for (int dy = -blur; dy <= height + blur; dy++) {
-        for (int dx = -blur; dx <= width + blur; dx++) {
-            int px = x + dx + offsetX;
-            int py = y + dy + offsetY;
-            
-            if (px < 0 || py < 0 || px >= (int)renderer.width() || py >= (int)renderer.height())
-                continue;
-            
-            // Distance from rectangle
-            int distX = 0, distY = 0;
-            if (dx < 0) distX = -dx;
-            else if (dx > width) distX = dx - width;
+    int originX = x + offsetX;
+    int originY = y + offsetY;
+    Renderer::Rect area = renderer.markDamage(originX - blur, originY - blur,
+                                              width + 2 * blur + 1, height + 2 * blur + 1);
+    if (area.w == 0) return;
+    
+    Renderer::Color shade(color.r, color.g, color.b);
+    const ShadowSlice* slices = nullptr;
+    if (blur > 0 && blur <= SHADOW_MAX_BLUR) slices = shadowSlices(blur, color.a);
+    
+    if (slices) {
+        for (int py = area.y; py < area.y + area.h; py++) {
+            int dy = py - originY;
+            int distY = 0;
             if (dy < 0) distY = -dy;
             else if (dy > height) distY = dy - height;
+            if (distY >= blur) continue;
             
-            int dist = isqrt(distX * distX + distY * distY);
+            const uint8_t* row = slices->edges + distY * 2 * blur;
+            renderer.blendRow(originX - blur, py, blur, shade, row);
+            renderer.fillRow(originX, py, width + 1, Renderer::Color(color.r, color.g, color.b, slices->middle[distY]));
+            renderer.blendRow(originX + width + 1, py, blur, shade, row + blur);
+        }
+        return;
+    }
+    
+    // Blur too large to cache: per-pixel distances
+    uint8_t alpha[SPAN_CHUNK];
+    for (int py = area.y; py < area.y + area.h; py++) {
+        int dy = py - originY;
+        int distY = 0;
+        if (dy < 0) distY = -dy;
+        else if (dy > height) distY = dy - height;
+        
+        for (int spanX = area.x; spanX < area.x + area.w; spanX += SPAN_CHUNK) {
+            int count = area.x + area.w - spanX;
+            if (count > SPAN_CHUNK) count = SPAN_CHUNK;
             
-            if (dist < blur) {
-                uint8_t alpha = (uint8_t)(((blur - dist) * color.a) / blur);
-                renderer.drawPixel(px, py, Renderer::Color(color.r, color.g, color.b, alpha));
+            for (int i = 0; i < count; i++) {
+                int dx = spanX + i - originX;
+                
+                // Distance from rectangle
+                int distX = 0;
+                if (dx < 0) distX = -dx;
+                else if (dx > width) distX = dx - width;
+                
+                alpha[i] = shadowAlpha(distX, distY, blur, color.a);
             }
+            renderer.blendRow(spanX, py, count, shade, alpha);
+        }
+    }
+}
+
+// ============================================================
+// GRADIENT CACHE
+// ============================================================
+
+// A gradient is constant along one axis, so a one-pixel strip along the
+// other describes it at any extent: row colors for vertical gradients, a
+// full row of target pixels for horizontal ones. Redrawing the same
+// gradient, like a full-screen background under a dirty clip, costs
+// one fill or row copy per row with no color math. A strip is cheaper to
+// replay than a cached full-screen surface, which would add a read of the
+// whole frame to every redraw.
+//
+// Each slot's strip is allocated once at MAX_GRADIENT_STRIP, since the
+// heap never frees; longer gradients are drawn without the cache.
+static const int GRADIENT_CACHE_SLOTS = 4;
+static const int MAX_GRADIENT_STRIP = 4096;
+
+struct GradientStrip {
+    uint32_t from, to;        // 0x00RRGGBB ends
+    int length;
+    bool horizontal;
+    bool swapRedBlue;         // Horizontal strips hold target pixels
+    uint32_t lastUse;
+    Surface* strip;           // MAX_GRADIENT_STRIP x 1
+};
+
+static GradientStrip s_gradientCache[GRADIENT_CACHE_SLOTS];
+static uint32_t s_gradientClock = 0;
+
+static inline uint32_t rgbOf(const Renderer::Color& c) {
+    return ((uint32_t)c.r << 16) | ((uint32_t)c.g << 8) | c.b;
+}
+
+static void buildGradientStrip(uint32_t* pixels, int length, Renderer::Color c1,
+                               Renderer::Color c2, bool horizontal) {
+    if (!horizontal) {
+        for (int py = 0; py < length; py++) {
+            uint8_t r = c1.r + ((c2.r - c1.r) * py) / length;
+            uint8_t g = c1.g + ((c2.g - c1.g) * py) / length;
+            uint8_t b = c1.b + ((c2.b - c1.b) * py) / length;
+            pixels[py] = ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+        }
+        return;
+    }
+    
+    // 16.16 ramp; callers pass the ends already in target channel order
+    GradientRamp ramp;
+    ramp.dr = (c2.r - c1.r) * 65536 / length;
+    ramp.dg = (c2.g - c1.g) * 65536 / length;
+    ramp.db = (c2.b - c1.b) * 65536 / length;
+    ramp.r = c1.r << 16;
+    ramp.g = c1.g << 16;
+    ramp.b = c1.b << 16;
+    PixelKernels::gradient(pixels, length, ramp);
+}
+
+// Strip for a gradient, built into the least recently used slot on a miss;
+// nullptr when it is too long to cache or there is no memory
+static const uint32_t* gradientStrip(Renderer::Color c1, Renderer::Color c2, int length,
+                                     bool horizontal, bool swapRedBlue) {
+    if (length > MAX_GRADIENT_STRIP) return nullptr;
+    
+    uint32_t from = rgbOf(c1);
+    uint32_t to = rgbOf(c2);
+    GradientStrip* victim = &s_gradientCache[0];
+    for (int i = 0; i < GRADIENT_CACHE_SLOTS; i++) {
+        GradientStrip& slot = s_gradientCache[i];
+        if (slot.strip && slot.from == from && slot.to == to && slot.length == length &&
+            slot.horizontal == horizontal && slot.swapRedBlue == swapRedBlue) {
+            slot.lastUse = ++s_gradientClock;
+            return slot.strip->pixels();
         }
+        if (!slot.strip || (victim->strip && slot.lastUse < victim->lastUse)) victim = &slot;
+    }
+    
+    // A failed strip is kept, so it is not allocated again on every miss
+    if (!victim->strip) victim->strip = new Surface(MAX_GRADIENT_STRIP, 1);
+    if (!victim->strip || !victim->strip->valid()) return nullptr;
+    
+    victim->from = from;
+    victim->to = to;
+    victim->length = length;
+    victim->horizontal = horizontal;
+    victim->swapRedBlue = swapRedBlue;
+    victim->lastUse = ++s_gradientClock;
+    if (horizontal && swapRedBlue) {
+        c1 = Renderer::Color(c1.b, c1.g, c1.r);
+        c2 = Renderer::Color(c2.b, c2.g, c2.r);
     }
+    buildGradientStrip(victim->strip->pixels(), length, c1, c2, horizontal);
+    return victim->strip->pixels();
 }
 
 void GfxEffects::gradient(Renderer& renderer, int x, int y, int width, int height,
                          Renderer::Color c1, Renderer::Color c2, bool horizontal) {
-    for (int py = 0; py < height; py++) {
-        for (int px = 0; px < width; px++) {
-            int t_num = horizontal ? px : py;
-            int t_den = horizontal ? width : height;
-            
-            uint8_t r = c1.r + ((c2.r - c1.r) * t_num) / t_den;
-            uint8_t g = c1.g + ((c2.g - c1.g) * t_num) / t_den;
-            uint8_t b = c1.b + ((c2.b - c1.b) * t_num) / t_den;
+    Renderer::Rect area = renderer.markDamage(x, y, width, height);
+    if (area.w == 0) return;
+    
+    bool swap = renderer.swapsRedBlue();
+    const uint32_t* strip = gradientStrip(c1, c2, horizontal ? width : height, horizontal,
+                                           horizontal && swap);
+    
+    if (!horizontal) {
+        // One color per row, filled by the span kernel
+        for (int py = area.y; py < area.y + area.h; py++) {
+            if (strip) {
+                uint32_t rgb = strip[py - y];
+                renderer.fillRow(area.x, py, area.w,
+                                 Renderer::Color(rgb >> 16, (rgb >> 8) & 0xFF, rgb & 0xFF));
+                continue;
+            }
             
-            renderer.drawPixel(x + px, y + py, Renderer::Color(r, g, b));
+            int t = py - y;
+            uint8_t r = c1.r + ((c2.r - c1.r) * t) / height;
+            uint8_t g = c1.g + ((c2.g - c1.g) * t) / height;
+            uint8_t b = c1.b + ((c2.b - c1.b) * t) / height;
+            renderer.fillRow(area.x, py, area.w, Renderer::Color(r, g, b));
+        }
+        return;
+    }
+    
+    // Horizontal: one precomputed row, copied into every row of the area
+    if (strip) {
+        for (int py = area.y; py < area.y + area.h; py++) {
+            renderer.copyRow(area.x, py, area.w, strip + (area.x - x));
+        }
+        return;
+    }
+    
+    // No memory for a strip: evaluate the ramp a chunk at a time
+    if (swap) {
+        c1 = Renderer::Color(c1.b, c1.g, c1.r);
+        c2 = Renderer::Color(c2.b, c2.g, c2.r);
+    }
+    
+    GradientRamp ramp;
+    ramp.dr = (c2.r - c1.r) * 65536 / width;
+    ramp.dg = (c2.g - c1.g) * 65536 / width;
+    ramp.db = (c2.b - c1.b) * 65536 / width;
+    
+    uint32_t pixels[SPAN_CHUNK];
+    for (int spanX = area.x; spanX < area.x + area.w; spanX += SPAN_CHUNK) {
+        int count = area.x + area.w - spanX;
+        if (count > SPAN_CHUNK) count = SPAN_CHUNK;
+        
+        int px = spanX - x;
+        ramp.r = (c1.r << 16) + px * ramp.dr;
+        ramp.g = (c1.g << 16) + px * ramp.dg;
+        ramp.b = (c1.b << 16) + px * ramp.db;
+        PixelKernels::gradient(pixels, count, ramp);
+        
+        for (int py = area.y; py < area.y + area.h; py++) {
+            renderer.copyRow(spanX, py, count, pixels);
         }
     }
 }
 
+// ============================================================
+// CIRCLE MASK CACHE
+// ============================================================
+
+// An AA disc is symmetric in both axes, so rows 0..radius + 2 below the
+// center describe all of it. Each row is a fully covered run around
+// the center with an edge on either side; the edges are stored as
+// coverage from the shared aa_coverage engine, left edge mirrored, ready
+// to hand to blendRow. Color and alpha are applied when drawing, so one
+// mask per radius serves every circle of that size.
+//
+// Masks live in one fixed pool. A miss evicts least recently used masks
+// until the new one fits, then compacts the survivors to the front.
+// Larger circles, whose masks would take most of the pool, are drawn
+// without one.
+static const int CIRCLE_CACHE_SLOTS = 32;
+static const int CIRCLE_CACHE_BYTES = 64 * 1024;
+static const int CIRCLE_MAX_RADIUS = 2048;    // Mask of about 23 KB
+
+struct CircleRow {
+    uint16_t inner;           // Fully covered pixels right of the center, center included
+    uint16_t edge;            // Edge pixels on each side
+    uint32_t offset;          // Left edge, then right edge, from the mask start
+};
+
+struct CircleMask {
+    int radius;
+    uint32_t lastUse;
+    int offset;               // Into the pool; -1 if unused
+    int size;
+};
+
+static CircleMask s_circleCache[CIRCLE_CACHE_SLOTS];
+static uint8_t* s_circlePool = nullptr;
+static int s_circlePoolUsed = 0;
+static uint32_t s_circleClock = 0;
+
+// Mask being built, allocated once for CIRCLE_MAX_RADIUS and a mask as
+// large as the pool
+static uint8_t* s_circleScratch = nullptr;
+static CircleRow* s_circleRows = nullptr;
+static uint8_t* s_circleLine = nullptr;
+
+// Rasterize the mask for radius into the scratch buffer and return its
+// size, or 0 if memory ran out or it would not fit the pool
+static int buildCircleMask(int radius) {
+    if (!s_circleRows) s_circleRows = new CircleRow[CIRCLE_MAX_RADIUS + 3];
+    if (!s_circleLine) s_circleLine = new uint8_t[CIRCLE_MAX_RADIUS + 3];
+    if (!s_circleScratch) s_circleScratch = new uint8_t[CIRCLE_CACHE_BYTES];
+    if (!s_circleRows || !s_circleLine || !s_circleScratch) return 0;
+    
+    int rows = radius + 3;
+    CircleRow* spans = s_circleRows;
+    uint8_t* line = s_circleLine;
+    
+    // Row spans first, so the edges can be laid out behind them
+    int size = rows * (int)sizeof(CircleRow);
+    for (int y = 0; y < rows; y++) {
+        aa_disc_span(line, 0, y, rows, radius * AA_SUBPIXEL, AA_SUBPIXEL);
+        int inner = 0;
+        while (inner < rows && line[inner] == 255) inner++;
+        int end = rows;
+        while (end > inner && line[end - 1] == 0) end--;
+        
+        spans[y].inner = (uint16_t)inner;
+        spans[y].edge = (uint16_t)(end - inner);
+        spans[y].offset = (uint32_t)size;
+        size += 2 * (end - inner);
+    }
+    size = (size + 7) & ~7;
+    if (size > CIRCLE_CACHE_BYTES) return 0;
+    
+    uint8_t* mask = s_circleScratch;
+    CircleRow* header = (CircleRow*)mask;
+    memcpy(header, spans, rows * sizeof(CircleRow));
+    
+    for (int y = 0; y < rows; y++) {
+        const CircleRow& row = header[y];
+        uint8_t* left = mask + row.offset;
+        uint8_t* right = left + row.edge;
+        aa_disc_span(right, row.inner, y, row.edge, radius * AA_SUBPIXEL, AA_SUBPIXEL);
+        for (int k = 0; k < row.edge; k++) {
+            left[row.edge - 1 - k] = right[k];
+        }
+    }
+    return size;
+}
+
+// Drop the least recently used masks until size more bytes fit, then
+// slide the remaining masks down over the gaps
+static CircleMask* reserveCircleMask(int size) {
+    if (!s_circlePool) {
+        s_circlePool = new uint8_t[CIRCLE_CACHE_BYTES];
+        if (!s_circlePool) return nullptr;
+        for (int i = 0; i < CIRCLE_CACHE_SLOTS; i++) s_circleCache[i].offset = -1;
+    }
+    
+    CircleMask* freeSlot = nullptr;
+    int live = 0;
+    for (int i = 0; i < CIRCLE_CACHE_SLOTS; i++) {
+        if (s_circleCache[i].offset < 0) freeSlot = &s_circleCache[i];
+        else live += s_circleCache[i].size;
+    }
+    
+    while (!freeSlot || live + size > CIRCLE_CACHE_BYTES) {
+        CircleMask* victim = nullptr;
+        for (int i = 0; i < CIRCLE_CACHE_SLOTS; i++) {
+            CircleMask& slot = s_circleCache[i];
+            if (slot.offset >= 0 && (!victim || slot.lastUse < victim->lastUse)) victim = &slot;
+        }
+        victim->offset = -1;
+        live -= victim->size;
+        freeSlot = victim;
+    }
+    
+    if (s_circlePoolUsed + size > CIRCLE_CACHE_BYTES) {
+        // Masks in pool order, each moved to the end of the one before
+        int cursor = 0;
+        for (;;) {
+            CircleMask* next = nullptr;
+            for (int i = 0; i < CIRCLE_CACHE_SLOTS; i++) {
+                CircleMask& slot = s_circleCache[i];
+                if (slot.offset >= cursor && (!next || slot.offset < next->offset)) next = &slot;
+            }
+            if (!next) break;
+            if (next->offset != cursor) {
+                memmove(s_circlePool + cursor, s_circlePool + next->offset, next->size);
+                next->offset = cursor;
+            }
+            cursor += next->size;
+        }
+        s_circlePoolUsed = cursor;
+    }
+    
+    freeSlot->offset = s_circlePoolUsed;
+    freeSlot->size = size;
+    s_circlePoolUsed += size;
+    return freeSlot;
+}
+
+// Mask for radius: cached, freshly cached, or left in the scratch buffer
+// if the pool cannot be allocated; nullptr past CIRCLE_MAX_RADIUS
+static const uint8_t* circleMask(int radius) {
+    if (radius > CIRCLE_MAX_RADIUS) return nullptr;
+    
+    for (int i = 0; i < CIRCLE_CACHE_SLOTS; i++) {
+        CircleMask& slot = s_circleCache[i];
+        if (s_circlePool && slot.offset >= 0 && slot.radius == radius) {
+            slot.lastUse = ++s_circleClock;
+            return s_circlePool + slot.offset;
+        }
+    }
+    
+    int size = buildCircleMask(radius);
+    if (size == 0) return nullptr;
+    
+    CircleMask* slot = reserveCircleMask(size);
+    if (!slot) return s_circleScratch;
+    slot->radius = radius;
+    slot->lastUse = ++s_circleClock;
+    memcpy(s_circlePool + slot->offset, s_circleScratch, size);
+    return s_circlePool + slot->offset;
+}
+
+// Each row is a mirrored left edge, one fill in the circle's color and a
+// right edge, so a cached circle costs no distance math at all. Coverage
+// is the analytic pixel area inside radius, so edges are one pixel wide
+// and free of the banding of a stepped distance fade.
 void GfxEffects::aaCircle(Renderer& renderer, int cx, int cy, int radius, Renderer::Color color) {
-    // Anti-aliased circle with smooth edges (integer math)
+    Renderer::Rect area = renderer.markDamage(cx - radius - 2, cy - radius - 2,
+                                              2 * radius + 5, 2 * radius + 5);
+    if (area.w == 0 || radius < 0 || color.a == 0) return;
+    
+    const uint8_t* mask = circleMask(radius);
+    if (!mask) {
+        // No mask: coverage straight from the disc, a chunk at a time
+        uint8_t coverage[SPAN_CHUNK];
+        for (int py = area.y; py < area.y + area.h; py++) {
+            for (int px = area.x; px < area.x + area.w; px += SPAN_CHUNK) {
+                int count = area.x + area.w - px;
+                if (count > SPAN_CHUNK) count = SPAN_CHUNK;
+                aa_disc_span(coverage, px - cx, py - cy, count, radius * AA_SUBPIXEL, AA_SUBPIXEL);
+                renderer.blendRow(px, py, count, color, coverage);
+            }
+        }
+        return;
+    }
+    
+    const CircleRow* rows = (const CircleRow*)mask;
+    for (int py = area.y; py < area.y + area.h; py++) {
+        int dy = py - cy;
+        const CircleRow& row = rows[dy < 0 ? -dy : dy];
+        const uint8_t* left = mask + row.offset;
+        
+        if (row.inner > 0) {
+            renderer.fillRow(cx - row.inner + 1, py, 2 * row.inner - 1, color);
+            renderer.blendRow(cx - row.inner - row.edge + 1, py, row.edge, color, left);
+        } else if (row.edge > 1) {
+            // The center pixel belongs to the right edge only
+            renderer.blendRow(cx - row.edge + 1, py, row.edge - 1, color, left);
+        }
+        renderer.blendRow(cx + row.inner, py, row.edge, color, left + row.edge);
+    }
+}
+
+// ============================================================
+// ROUNDED RECTS
+// ============================================================
+
+// A rounded rect with whole-pixel sides. Its signed distance field is
+// exactly the pixel grid along the straight sides, so only pixels in a
+// corner's radius x radius square need coverage; there the distance to
+// the corner center goes through the shared coverage LUT.
+struct RoundedBox {
+    int x, y, w, h;
+    int radius[4];            // Clockwise from the top left
+};
+
+static RoundedBox roundedBox(int x, int y, int width, int height,
+                             const GfxEffects::CornerRadii& radii) {
+    RoundedBox box = {x, y, width, height,
+                      {radii.topLeft, radii.topRight, radii.bottomRight, radii.bottomLeft}};
+    int limit = (width < height ? width : height) / 2;
+    for (int i = 0; i < 4; i++) {
+        if (box.radius[i] < 0) box.radius[i] = 0;
+        if (box.radius[i] > limit) box.radius[i] = limit;
+    }
+    return box;
+}
+
+// Corner arcs crossed by row py: radius and the row center's offset from
+// the arc center in subpixels, or radius 0 where the side is straight
+struct RoundedRow {
+    int leftRadius, leftDy;
+    int rightRadius, rightDy;
+};
 
+static RoundedRow roundedRow(const RoundedBox& box, int py) {
+    RoundedRow row = {0, 0, 0, 0};
+    int fromTop = py - box.y;
+    int fromBottom = box.y + box.h - 1 - py;
     
-    for (int y = -radius - 2; y <= radius + 2; y++) {
-        for (int x = -radius - 2; x <= radius + 2; x++) {
-            int dist2 = x * x + y * y;
-            int dist = isqrt(dist2);
-            
-            if (dist < radius + 2) {
-                uint8_t alpha;
-                if (dist < radius - 1) {
-                    alpha = color.a;  // Inside
-                } else if (dist > radius + 1) {
-                    continue;  // Outside
-                } else {
-                    // Anti-aliased edge (smooth transition)
-                    int fade = (radius + 1 - dist);
-                    alpha = (uint8_t)((fade * color.a) / 2);
-                }
-                
-                int px = cx + x;
-                int py = cy + y;
+    if (fromTop < box.radius[0]) {
+        row.leftRadius = box.radius[0];
+        row.leftDy = (fromTop - box.radius[0]) * AA_SUBPIXEL + AA_SUBPIXEL / 2;
+    } else if (fromBottom < box.radius[3]) {
+        row.leftRadius = box.radius[3];
+        row.leftDy = (box.radius[3] - fromBottom) * AA_SUBPIXEL - AA_SUBPIXEL / 2;
+    }
+    if (fromTop < box.radius[1]) {
+        row.rightRadius = box.radius[1];
+        row.rightDy = (fromTop - box.radius[1]) * AA_SUBPIXEL + AA_SUBPIXEL / 2;
+    } else if (fromBottom < box.radius[2]) {
+        row.rightRadius = box.radius[2];
+        row.rightDy = (box.radius[2] - fromBottom) * AA_SUBPIXEL - AA_SUBPIXEL / 2;
+    }
+    return row;
+}
+
+// Coverage of columns [px0, px0 + count) of one row of box. Columns off
+// the arcs are 0 or 255 without any math.
+static void roundedCoverage(const RoundedBox& box, const RoundedRow& row,
+                            int px0, int count, uint8_t* coverage) {
+    int leftArc = box.x + row.leftRadius;
+    int rightArc = box.x + box.w - row.rightRadius;
+    
+    for (int i = 0; i < count; ) {
+        int px = px0 + i;
+        int run;
+        if (px < box.x || px >= box.x + box.w) {
+            run = px < box.x ? box.x - px : count - i;
+            if (run > count - i) run = count - i;
+            memset(coverage + i, 0, run);
+        } else if (px < leftArc) {
+            run = leftArc - px;
+            if (run > count - i) run = count - i;
+            aa_disc_span_subpixel(coverage + i, (px - leftArc) * AA_SUBPIXEL + AA_SUBPIXEL / 2,
+                                  row.leftDy, run, row.leftRadius * AA_SUBPIXEL, AA_SUBPIXEL);
+        } else if (px < rightArc) {
+            run = rightArc - px;
+            if (run > count - i) run = count - i;
+            memset(coverage + i, 255, run);
+        } else {
+            run = box.x + box.w - px;
+            if (run > count - i) run = count - i;
+            aa_disc_span_subpixel(coverage + i, (px - rightArc) * AA_SUBPIXEL + AA_SUBPIXEL / 2,
+                                  row.rightDy, run, row.rightRadius * AA_SUBPIXEL, AA_SUBPIXEL);
+        }
+        i += run;
+    }
+}
+
+// Hand a row of coverage to the renderer: full runs as solid fills, the
+// rest as one blend each
+static void emitCoverage(Renderer& renderer, int x, int y, const uint8_t* coverage,
+                         int count, Renderer::Color color) {
+    int i = 0;
+    while (i < count) {
+        int start = i;
+        if (coverage[i] == 255) {
+            while (i < count && coverage[i] == 255) i++;
+            renderer.fillRow(x + start, y, i - start, color);
+        } else {
+            while (i < count && coverage[i] != 255) i++;
+            renderer.blendRow(x + start, y, i - start, color, coverage + start);
+        }
+    }
+}
+
+// Coverage of outer minus inner for columns [px0, px0 + count), which
+// lie in one row's left or right band
+static void bandCoverage(const RoundedBox& outer, const RoundedRow& outerRow,
+                         const RoundedBox* inner, const RoundedRow& innerRow,
+                         int px0, int count, uint8_t* coverage) {
+    uint8_t hole[SPAN_CHUNK];
+    roundedCoverage(outer, outerRow, px0, count, coverage);
+    if (!inner) return;
+    
+    roundedCoverage(*inner, innerRow, px0, count, hole);
+    for (int i = 0; i < count; i++) {
+        coverage[i] = coverage[i] > hole[i] ? coverage[i] - hole[i] : 0;
+    }
+}
+
+// Each row of the shape is a left band holding the outer arc and, for a
+// stroke, the inner one; a solid middle or, for a stroke, a hole; and a
+// right band. Only the bands get coverage, so every pixel is written once.
+static void drawRoundedBox(Renderer& renderer, const RoundedBox& outer, const RoundedBox* inner,
+                           Renderer::Color color) {
+    Renderer::Rect area = renderer.markDamage(outer.x, outer.y, outer.w, outer.h);
+    if (area.w == 0 || color.a == 0) return;
+    
+    uint8_t coverage[SPAN_CHUNK];
+    for (int py = area.y; py < area.y + area.h; py++) {
+        RoundedRow outerRow = roundedRow(outer, py);
+        RoundedRow innerRow = {0, 0, 0, 0};
+        const RoundedBox* hole = nullptr;
+        int left = outerRow.leftRadius;
+        int right = outerRow.rightRadius;
+        
+        if (inner && py >= inner->y && py < inner->y + inner->h) {
+            hole = inner;
+            innerRow = roundedRow(*inner, py);
+            int innerLeft = inner->x - outer.x + innerRow.leftRadius;
+            int innerRight = outer.x + outer.w - inner->x - inner->w + innerRow.rightRadius;
+            if (innerLeft > left) left = innerLeft;
+            if (innerRight > right) right = innerRight;
+        }
+        
+        int bands[2][2] = {{outer.x, left}, {outer.x + outer.w - right, right}};
+        for (int side = 0; side < 2; side++) {
+            for (int done = 0; done < bands[side][1]; done += SPAN_CHUNK) {
+                int count = bands[side][1] - done;
+                if (count > SPAN_CHUNK) count = SPAN_CHUNK;
                 
-                if (px >= 0 && py >= 0 && px < (int)renderer.width() && py < (int)renderer.height()) {
-                    renderer.drawPixel(px, py, 
-                                     Renderer::Color(color.r, color.g, color.b, alpha));
-                }
+                int px = bands[side][0] + done;
+                bandCoverage(outer, outerRow, hole, innerRow, px, count, coverage);
+                emitCoverage(renderer, px, py, coverage, count, color);
+            }
+            if (side == 0 && !hole) {
+                renderer.fillRow(outer.x + left, py, outer.w - left - right, color);
             }
         }
     }
 }
 
+void GfxEffects::fillRoundedRect(Renderer& renderer, int x, int y, int width, int height,
+                                 const CornerRadii& radii, Renderer::Color color) {
+    if (width <= 0 || height <= 0) return;
+    drawRoundedBox(renderer, roundedBox(x, y, width, height, radii), nullptr, color);
+}
+
+// The stroke is the rect minus the rect inset by strokeWidth, whose
+// corners shrink by the same amount so the band keeps its width
+void GfxEffects::strokeRoundedRect(Renderer& renderer, int x, int y, int width, int height,
+                                   const CornerRadii& radii, int strokeWidth,
+                                   Renderer::Color color) {
+    if (width <= 0 || height <= 0 || strokeWidth <= 0) return;
+    
+    RoundedBox outer = roundedBox(x, y, width, height, radii);
+    if (2 * strokeWidth >= width || 2 * strokeWidth >= height) {
+        drawRoundedBox(renderer, outer, nullptr, color);
+        return;
+    }
+    
+    RoundedBox inner = outer;
+    inner.x += strokeWidth;
+    inner.y += strokeWidth;
+    inner.w -= 2 * strokeWidth;
+    inner.h -= 2 * strokeWidth;
+    for (int i = 0; i < 4; i++) {
+        inner.radius[i] = outer.radius[i] > strokeWidth ? outer.radius[i] - strokeWidth : 0;
+    }
+    drawRoundedBox(renderer, outer, &inner, color);
+}
+
 void GfxEffects::aaRoundedRect(Renderer& renderer, int x, int y, int width, int height,
                               int radius, Renderer::Color color, bool filled) {
-    if (!filled) {
-        // TODO: Outline version
+    if (filled) {
+        fillRoundedRect(renderer, x, y, width, height, CornerRadii(radius), color);
+    } else {
+        strokeRoundedRect(renderer, x, y, width, height, CornerRadii(radius), 1, color);
+    }
+}
+
+// ============================================================
+// LINES
+// ============================================================
+
+// Wu's algorithm: step along the major axis and split each step between
+// the two pixels straddling the exact minor coordinate
+void GfxEffects::aaLine(Renderer& renderer, int x0, int y0, int x1, int y1, Renderer::Color color) {
+    int left = x0 < x1 ? x0 : x1;
+    int top = y0 < y1 ? y0 : y1;
+    int dx = x1 - x0;
+    int dy = y1 - y0;
+    Renderer::Rect area = renderer.markDamage(left, top, (dx < 0 ? -dx : dx) + 2,
+                                              (dy < 0 ? -dy : dy) + 2);
+    if (area.w == 0 || color.a == 0) return;
+    
+    bool steep = (dy < 0 ? -dy : dy) > (dx < 0 ? -dx : dx);
+    if (steep) {
+        int t = x0; x0 = y0; y0 = t;
+        t = x1; x1 = y1; y1 = t;
+    }
+    if (x0 > x1) {
+        int t = x0; x0 = x1; x1 = t;
+        t = y0; y0 = y1; y1 = t;
+    }
+    
+    // Minor coordinate in 16.16; lines are between pixel centers, so the
+    // end pixels are exact and need no special casing
+    int32_t gradient = x1 > x0 ? (int32_t)((int64_t)(y1 - y0) * 65536 / (x1 - x0)) : 0;
+    int32_t minor = y0 * 65536;
+    for (int major = x0; major <= x1; major++, minor += gradient) {
+        int base = minor >> 16;
+        uint32_t frac = (minor >> 8) & 0xFF;
+        for (int k = 0; k < 2; k++) {
+            uint32_t coverage = k == 0 ? 255 - frac : frac;
+            if (coverage == 0) continue;
+            
+            int px = steep ? base + k : major;
+            int py = steep ? major : base + k;
+            if (px < area.x || px >= area.x + area.w || py < area.y || py >= area.y + area.h) continue;
+            renderer.blendPixel(px, py, Renderer::Color(color.r, color.g, color.b,
+                                                        mulAlpha(color.a, coverage)));
+        }
+    }
+}
+
+// A stroke is a union of convex pieces. Round strokes are capsules, the
+// points within half the width of a segment, which gives round joins and
+// caps for free. Miter strokes are butt-ended boxes plus a wedge filling
+// the outside of each join. Every piece is bounded by half-planes, which
+// also give its exact column range on a row, so each row only visits
+// pixels near the stroke and each pixel takes the best coverage of the
+// pieces over it: one coverage value and one write per pixel.
+static const int UNIT_SHIFT = 14;       // Unit vectors are Q14
+static const int MITER_LIMIT = 4;       // Longer miters are beveled
+
+struct HalfPlane {
+    int32_t nx, ny;           // Outward unit normal, Q14
+    int64_t offset;           // n . p at the edge, subpixels in Q14
+};
+
+struct StrokePiece {
+    HalfPlane planes[4];      // Exact for boxes and wedges, bounding for capsules
+    int planeCount;
+    uint8_t seams;            // Planes shared with a neighbor piece, bit per plane
+    bool capsule;
+    int32_t ax, ay, bx, by;   // Capsule segment, subpixels
+    int32_t ux, uy;           // Capsule unit direction, Q14
+    int64_t length;           // Capsule length, subpixels
+    int top, bottom;          // Rows touched, inclusive
+};
+
+struct StrokeSpan {
+    int x0, x1;               // Columns, half-open
+};
+
+// Pieces live in fixed scratch, at most two per point. Longer polylines
+// are stroked in batches that share their last segment, so every join
+// keeps its shape; a translucent stroke blends that segment twice.
+static const int STROKE_MAX_POINTS = 256;
+static const int STROKE_MAX_PIECES = 2 * STROKE_MAX_POINTS;
+static StrokePiece* s_strokePieces = nullptr;
+static StrokeSpan* s_strokeSpans = nullptr;
+static uint8_t* s_strokeActive = nullptr;
+
+static uint32_t sqrt64(uint64_t x) {
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > x) bit >>= 2;
+    while (bit != 0) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+static inline int32_t subpixel(int p) {
+    return p * AA_SUBPIXEL + AA_SUBPIXEL / 2;
+}
+
+static HalfPlane halfPlane(int32_t nx, int32_t ny, int32_t px, int32_t py, int32_t distance) {
+    HalfPlane plane;
+    plane.nx = nx;
+    plane.ny = ny;
+    plane.offset = (int64_t)nx * px + (int64_t)ny * py + (int64_t)distance * (1 << UNIT_SHIFT);
+    return plane;
+}
+
+// Signed distance from the piece's edge in subpixels, positive outside.
+// Exact near every edge, which is all the coverage LUT looks at. Seams
+// are not edges of the stroke: a pixel center on one side belongs wholly
+// to one piece, or every pixel along a join would be half covered twice.
+static inline int32_t planeDistance(const StrokePiece& piece, int64_t px, int64_t py) {
+    int64_t worst = INT64_MIN;
+    for (int i = 0; i < piece.planeCount; i++) {
+        const HalfPlane& plane = piece.planes[i];
+        int64_t d = plane.nx * px + plane.ny * py - plane.offset;
+        if (piece.seams & (1 << i)) {
+            if (d > 0) return INT32_MAX / 2;
+            continue;
+        }
+        if (d > worst) worst = d;
+    }
+    return (int32_t)(worst / (1 << UNIT_SHIFT));
+}
+
+static uint8_t pieceCoverage(const StrokePiece& piece, int32_t halfWidth, int64_t px, int64_t py) {
+    if (!piece.capsule) return aa_edge_coverage(-planeDistance(piece, px, py));
+    
+    int64_t dx = px - piece.ax;
+    int64_t dy = py - piece.ay;
+    int64_t along = (dx * piece.ux + dy * piece.uy) >> UNIT_SHIFT;
+    int64_t distSq;
+    if (along <= 0) {
+        distSq = dx * dx + dy * dy;
+    } else if (along >= piece.length) {
+        int64_t ex = px - piece.bx;
+        int64_t ey = py - piece.by;
+        distSq = ex * ex + ey * ey;
+    } else {
+        int64_t perp = (dy * piece.ux - dx * piece.uy) >> UNIT_SHIFT;
+        distSq = perp * perp;
+    }
+    
+    int64_t inner = halfWidth - AA_SUBPIXEL;
+    int64_t outer = halfWidth + AA_SUBPIXEL;
+    if (inner > 0 && distSq < inner * inner) return 255;
+    if (distSq >= outer * outer) return 0;
+    return aa_edge_coverage(halfWidth - (int32_t)sqrt64((uint64_t)distSq));
+}
+
+// Columns whose centers may be within a pixel of the piece on row py
+static bool pieceSpan(const StrokePiece& piece, int py, StrokeSpan& span) {
+    const int64_t margin = (int64_t)AA_SUBPIXEL << UNIT_SHIFT;
+    int64_t yc = subpixel(py);
+    int64_t lo = INT64_MIN / 4;
+    int64_t hi = INT64_MAX / 4;
+    
+    for (int i = 0; i < piece.planeCount; i++) {
+        const HalfPlane& plane = piece.planes[i];
+        int64_t room = plane.offset + margin - plane.ny * yc;
+        if (plane.nx == 0) {
+            if (room < 0) return false;
+        } else if (plane.nx > 0) {
+            int64_t bound = room / plane.nx;
+            if (bound < hi) hi = bound;
+        } else {
+            int64_t bound = room / plane.nx;
+            if (bound > lo) lo = bound;
+        }
+    }
+    if (lo > hi) return false;
+    
+    // Subpixel range to pixel columns, with a column of slack for rounding
+    span.x0 = (int)((lo - AA_SUBPIXEL / 2) >> 4) - 1;
+    span.x1 = (int)((hi - AA_SUBPIXEL / 2) >> 4) + 2;
+    return true;
+}
+
+static void unitVector(int32_t dx, int32_t dy, int32_t& ux, int32_t& uy, int64_t& length) {
+    length = sqrt64((uint64_t)((int64_t)dx * dx + (int64_t)dy * dy));
+    if (length == 0) {
+        ux = 1 << UNIT_SHIFT;
+        uy = 0;
         return;
     }
+    ux = (int32_t)((int64_t)dx * (1 << UNIT_SHIFT) / length);
+    uy = (int32_t)((int64_t)dy * (1 << UNIT_SHIFT) / length);
+}
+
+// Box around segment a-b, extended past both ends by extend
+static void segmentBox(StrokePiece& piece, int32_t ax, int32_t ay, int32_t bx, int32_t by,
+                       int32_t ux, int32_t uy, int32_t halfWidth, int32_t extend) {
+    piece.planes[0] = halfPlane(-ux, -uy, ax, ay, extend);
+    piece.planes[1] = halfPlane(ux, uy, bx, by, extend);
+    piece.planes[2] = halfPlane(-uy, ux, ax, ay, halfWidth);
+    piece.planes[3] = halfPlane(uy, -ux, ax, ay, halfWidth);
+    piece.planeCount = 4;
+}
+
+// Outer corner of the join at p between directions u and v: past the end
+// of the first segment, before the start of the second, and inside both
+// outer edges, or inside the bevel chord when the miter is too long
+static bool joinWedge(StrokePiece& piece, int32_t px, int32_t py, int32_t ux, int32_t uy,
+                      int32_t vx, int32_t vy, int32_t halfWidth) {
+    const int64_t one = 1 << UNIT_SHIFT;
+    int64_t cross = (int64_t)ux * vy - (int64_t)uy * vx;
+    int64_t dot = (int64_t)ux * vx + (int64_t)uy * vy;
+    if (cross == 0) return false;
+    
+    // Outer normals face away from the turn
+    int32_t n1x = -uy, n1y = ux;
+    if ((int64_t)n1x * vx + (int64_t)n1y * vy > 0) { n1x = -n1x; n1y = -n1y; }
+    int32_t n2x = -vy, n2y = vx;
+    if ((int64_t)n2x * ux + (int64_t)n2y * uy < 0) { n2x = -n2x; n2y = -n2y; }
+    
+    piece.planes[0] = halfPlane(-ux, -uy, px, py, 0);
+    piece.planes[1] = halfPlane(vx, vy, px, py, 0);
+    piece.planeCount = 2;
+    
+    // Miter length over half width is sqrt(2 / (1 + u.v))
+    if ((one + dot) * MITER_LIMIT * MITER_LIMIT >= 2 * one) {
+        piece.planes[2] = halfPlane(n1x, n1y, px, py, halfWidth);
+        piece.planes[3] = halfPlane(n2x, n2y, px, py, halfWidth);
+        piece.planeCount = 4;
+    } else {
+        int32_t mx, my;
+        int64_t unused;
+        unitVector(n1x + n2x, n1y + n2y, mx, my, unused);
+        int64_t chord = ((int64_t)halfWidth * (((int64_t)mx * n1x + (int64_t)my * n1y) >> UNIT_SHIFT))
+                        >> UNIT_SHIFT;
+        piece.planes[2] = halfPlane(mx, my, px, py, (int32_t)chord);
+        piece.planeCount = 3;
+    }
+    return true;
+}
+
+void GfxEffects::aaPolyline(Renderer& renderer, const Point* points, int count, int width,
+                            Renderer::Color color, LineJoin join) {
+    if (count <= 0 || width <= 0 || color.a == 0) return;
+    
+    while (count > STROKE_MAX_POINTS) {
+        aaPolyline(renderer, points, STROKE_MAX_POINTS, width, color, join);
+        points += STROKE_MAX_POINTS - 2;
+        count -= STROKE_MAX_POINTS - 2;
+    }
+    
+    int32_t halfWidth = width * AA_SUBPIXEL / 2;
+    int reach = width / 2 + 2;
+    int minX = points[0].x, maxX = points[0].x, minY = points[0].y, maxY = points[0].y;
+    for (int i = 1; i < count; i++) {
+        if (points[i].x < minX) minX = points[i].x;
+        if (points[i].x > maxX) maxX = points[i].x;
+        if (points[i].y < minY) minY = points[i].y;
+        if (points[i].y > maxY) maxY = points[i].y;
+    }
+    if (join == JOIN_MITER) reach = width * MITER_LIMIT / 2 + 2;
+    Renderer::Rect area = renderer.markDamage(minX - reach, minY - reach,
+                                              maxX - minX + 2 * reach + 1,
+                                              maxY - minY + 2 * reach + 1);
+    if (area.w == 0) return;
+    
+    if (!s_strokePieces) s_strokePieces = new StrokePiece[STROKE_MAX_PIECES];
+    if (!s_strokeSpans) s_strokeSpans = new StrokeSpan[STROKE_MAX_PIECES];
+    if (!s_strokeActive) s_strokeActive = new uint8_t[STROKE_MAX_PIECES];
+    if (!s_strokePieces || !s_strokeSpans || !s_strokeActive) return;
+    StrokePiece* pieces = s_strokePieces;
+    StrokeSpan* spans = s_strokeSpans;
+    uint8_t* active = s_strokeActive;
+    
+    int pieceCount = 0;
+    int prevBox = -1;
+    int32_t prevUx = 0, prevUy = 0;
+    int segments = count > 1 ? count - 1 : 1;
+    for (int i = 0; i < segments; i++) {
+        const Point& a = points[i];
+        const Point& b = points[count > 1 ? i + 1 : i];
+        int32_t ax = subpixel(a.x), ay = subpixel(a.y);
+        int32_t bx = subpixel(b.x), by = subpixel(b.y);
+        int32_t ux, uy;
+        int64_t length;
+        unitVector(bx - ax, by - ay, ux, uy, length);
+        
+        if (join == JOIN_MITER && length == 0) continue;
+        
+        // Boxes meeting at a join end in seams, not butt caps, unless the
+        // stroke turns straight back on itself
+        bool joined = false;
+        if (join == JOIN_MITER && prevBox >= 0) {
+            StrokePiece& wedge = pieces[pieceCount];
+            if (joinWedge(wedge, ax, ay, prevUx, prevUy, ux, uy, halfWidth)) {
+                wedge.capsule = false;
+                wedge.seams = 3;
+                wedge.top = a.y - reach;
+                wedge.bottom = a.y + reach;
+                pieceCount++;
+                joined = true;
+            } else {
+                joined = (int64_t)prevUx * ux + (int64_t)prevUy * uy > 0;
+            }
+            if (joined) pieces[prevBox].seams |= 2;
+        }
+        
+        prevBox = pieceCount;
+        StrokePiece& piece = pieces[pieceCount++];
+        bool round = join == JOIN_ROUND;
+        segmentBox(piece, ax, ay, bx, by, ux, uy, halfWidth, round ? halfWidth : 0);
+        piece.capsule = round;
+        piece.seams = joined ? 1 : 0;
+        piece.ax = ax;
+        piece.ay = ay;
+        piece.bx = bx;
+        piece.by = by;
+        piece.ux = ux;
+        piece.uy = uy;
+        piece.length = length;
+        piece.top = (a.y < b.y ? a.y : b.y) - reach;
+        piece.bottom = (a.y > b.y ? a.y : b.y) + reach;
+        prevUx = ux;
+        prevUy = uy;
+    }
+    
+    uint8_t coverage[SPAN_CHUNK];
+    for (int py = area.y; py < area.y + area.h; py++) {
+        // Column ranges of the pieces on this row, sorted by start
+        int spanCount = 0;
+        for (int i = 0; i < pieceCount; i++) {
+            active[i] = 0;
+            if (py < pieces[i].top || py > pieces[i].bottom) continue;
+            
+            StrokeSpan span;
+            if (!pieceSpan(pieces[i], py, span)) continue;
+            if (span.x0 < area.x) span.x0 = area.x;
+            if (span.x1 > area.x + area.w) span.x1 = area.x + area.w;
+            if (span.x0 >= span.x1) continue;
+            
+            active[i] = 1;
+            int k = spanCount++;
+            while (k > 0 && spans[k - 1].x0 > span.x0) {
+                spans[k] = spans[k - 1];
+                k--;
+            }
+            spans[k] = span;
+        }
+        
+        int64_t yc = subpixel(py);
+        for (int s = 0; s < spanCount; ) {
+            // Merge overlapping ranges so no column is visited twice
+            int x0 = spans[s].x0;
+            int x1 = spans[s].x1;
+            for (s++; s < spanCount && spans[s].x0 <= x1; s++) {
+                if (spans[s].x1 > x1) x1 = spans[s].x1;
+            }
+            
+            for (int chunk = x0; chunk < x1; chunk += SPAN_CHUNK) {
+                int n = x1 - chunk;
+                if (n > SPAN_CHUNK) n = SPAN_CHUNK;
+                
+                for (int i = 0; i < n; i++) {
+                    int64_t xc = subpixel(chunk + i);
+                    uint8_t best = 0;
+                    for (int p = 0; p < pieceCount && best < 255; p++) {
+                        if (!active[p]) continue;
+                        uint8_t c = pieceCoverage(pieces[p], halfWidth, xc, yc);
+                        if (c > best) best = c;
+                    }
+                    coverage[i] = best;
+                }
+                emitCoverage(renderer, chunk, py, coverage, n, color);
+            }
+        }
+    }
+}
+
+// ============================================================
+// POLYGONS
+// ============================================================
+
+// Polygons are scan converted with an active edge table. Edges are sorted
+// by the first sample row they cross and join the active list there; on
+// each sample row the active crossings are sorted and the fill rule turns
+// them into spans. Without anti-aliasing there is one sample row per
+// pixel row, through pixel centers, and each span is one fillRow. With it
+// there are AA_SUBPIXEL sample rows per pixel row, each span adds its
+// exact horizontal coverage to the row, and interior runs still go to
+// fillRow whole.
+struct PolyEdge {
+    int64_t x;                // Crossing on the current sample row, 24.8 with 16 more bits
+    int64_t step;             // Change in x per sample row
+    int32_t x0, y0, x1, y1;   // Endpoints with y0 < y1, 24.8
+    int first, last;          // Sample rows crossed, inclusive
+    int winding;              // +1 where the contour runs down, -1 up
+};
+
+// Edge table, allocated once; polygons with more edges are not drawn
+static const int POLY_MAX_EDGES = 1024;
+static PolyEdge* s_polyEdges = nullptr;
+static int* s_polyActive = nullptr;
+
+// Coverage rows, allocated once to the width of the first renderer that
+// fills an anti-aliased polygon; a wider clip is filled in strips of it
+static int32_t* s_polyCover = nullptr;
+static int32_t* s_polyCarry = nullptr;
+static int s_polyRowWidth = 0;
+
+static const int FIXED_ONE = 1 << GfxEffects::FIXED_SHIFT;
+
+static inline int64_t floorDiv(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    if ((a % b != 0) && ((a < 0) != (b < 0))) q--;
+    return q;
+}
+
+// Crossing of the edge with sample row s, whose center is s * pitch +
+// pitch / 2 in 24.8
+static inline int64_t edgeCrossing(const PolyEdge& edge, int s, int pitch) {
+    int64_t y = (int64_t)s * pitch + pitch / 2;
+    return (int64_t)edge.x0 * 65536 +
+           (y - edge.y0) * ((int64_t)(edge.x1 - edge.x0) * 65536) / (edge.y1 - edge.y0);
+}
+
+void GfxEffects::fillPolygon(Renderer& renderer, const FixedPoint* points, int count,
+                             Renderer::Color color, FillRule rule, bool antialias) {
+    if (count < 3 || color.a == 0) return;
+    
+    int32_t minX = points[0].x, maxX = points[0].x, minY = points[0].y, maxY = points[0].y;
+    for (int i = 1; i < count; i++) {
+        if (points[i].x < minX) minX = points[i].x;
+        if (points[i].x > maxX) maxX = points[i].x;
+        if (points[i].y < minY) minY = points[i].y;
+        if (points[i].y > maxY) maxY = points[i].y;
+    }
+    int left = floorDiv(minX, FIXED_ONE);
+    int top = floorDiv(minY, FIXED_ONE);
+    int right = floorDiv(maxX + FIXED_ONE - 1, FIXED_ONE);
+    int bottom = floorDiv(maxY + FIXED_ONE - 1, FIXED_ONE);
+    Renderer::Rect area = renderer.markDamage(left, top, right - left, bottom - top);
+    if (area.w == 0 || count > POLY_MAX_EDGES) return;
+    
+    if (antialias && !s_polyCover) {
+        int width = (int)renderer.width();
+        s_polyCover = new int32_t[width + 1];
+        s_polyCarry = new int32_t[width + 1];
+        if (!s_polyCover || !s_polyCarry) return;
+        memset(s_polyCover, 0, (width + 1) * sizeof(int32_t));
+        memset(s_polyCarry, 0, (width + 1) * sizeof(int32_t));
+        s_polyRowWidth = width;
+    }
+    if (antialias && area.w > s_polyRowWidth) {
+        for (int x = area.x; x < area.x + area.w; x += s_polyRowWidth) {
+            renderer.pushClip(x, area.y, s_polyRowWidth, area.h);
+            fillPolygon(renderer, points, count, color, rule, antialias);
+            renderer.popClip();
+        }
+        return;
+    }
+    
+    if (!s_polyEdges) s_polyEdges = new PolyEdge[POLY_MAX_EDGES];
+    if (!s_polyActive) s_polyActive = new int[POLY_MAX_EDGES];
+    if (!s_polyEdges || !s_polyActive) return;
+    PolyEdge* edges = s_polyEdges;
+    int* active = s_polyActive;
+    
+    int samples = antialias ? AA_SUBPIXEL : 1;
+    int pitch = FIXED_ONE / samples;
+    int firstSample = area.y * samples;
+    int lastSample = (area.y + area.h) * samples - 1;
+    
+    // Edges crossing a sample row in the clip, sorted by their first row
+    int edgeCount = 0;
+    for (int i = 0; i < count; i++) {
+        const FixedPoint& a = points[i];
+        const FixedPoint& b = points[i + 1 < count ? i + 1 : 0];
+        if (a.y == b.y) continue;
+        
+        PolyEdge edge;
+        bool down = a.y < b.y;
+        edge.x0 = down ? a.x : b.x;
+        edge.y0 = down ? a.y : b.y;
+        edge.x1 = down ? b.x : a.x;
+        edge.y1 = down ? b.y : a.y;
+        edge.winding = down ? 1 : -1;
+        edge.first = floorDiv(edge.y0 - pitch / 2 + pitch - 1, pitch);
+        edge.last = floorDiv(edge.y1 - pitch / 2 - 1, pitch);
+        if (edge.first < firstSample) edge.first = firstSample;
+        if (edge.last > lastSample) edge.last = lastSample;
+        if (edge.first > edge.last) continue;
+        edge.step = (int64_t)(edge.x1 - edge.x0) * 65536 * pitch / (edge.y1 - edge.y0);
+        
+        int k = edgeCount++;
+        while (k > 0 && edges[k - 1].first > edge.first) {
+            edges[k] = edges[k - 1];
+            k--;
+        }
+        edges[k] = edge;
+    }
+    if (edgeCount == 0) return;
+    
+    // Coverage accumulators: cover holds partial pixels, carry the +-one
+    // pixel steps at the ends of each span's full run, so a span costs the
+    // same however wide it is. Both span the clip plus one column and are
+    // left zeroed after each pixel row.
+    int32_t* cover = s_polyCover;
+    int32_t* carry = s_polyCarry;
+    
+    int64_t clipLeft = (int64_t)area.x * FIXED_ONE;
+    int64_t clipRight = (int64_t)(area.x + area.w) * FIXED_ONE;
+    int touchedMin = area.w;
+    int touchedMax = -1;
+    int activeCount = 0;
+    int next = 0;
+    uint8_t coverage[SPAN_CHUNK];
+    
+    for (int s = edges[0].first; s <= lastSample; s++) {
+        // Retire finished edges, admit new ones, keep the list sorted by x
+        int kept = 0;
+        for (int i = 0; i < activeCount; i++) {
+            PolyEdge& edge = edges[active[i]];
+            if (edge.last < s) continue;
+            edge.x += edge.step;
+            active[kept++] = active[i];
+        }
+        activeCount = kept;
+        for (; next < edgeCount && edges[next].first == s; next++) {
+            edges[next].x = edgeCrossing(edges[next], s, pitch);
+            active[activeCount++] = next;
+        }
+        if (activeCount == 0 && next == edgeCount && (s - firstSample) % samples == 0) break;
+        for (int i = 1; i < activeCount; i++) {
+            int index = active[i];
+            int k = i;
+            while (k > 0 && edges[active[k - 1]].x > edges[index].x) {
+                active[k] = active[k - 1];
+                k--;
+            }
+            active[k] = index;
+        }
+        
+        int py = floorDiv(s, samples);
+        int winding = 0;
+        for (int i = 0; i + 1 < activeCount; i++) {
+            const PolyEdge& edge = edges[active[i]];
+            winding += edge.winding;
+            bool inside = rule == FILL_EVENODD ? (winding & 1) != 0 : winding != 0;
+            if (!inside) continue;
+            
+            int64_t xa = edge.x;
+            int64_t xb = edges[active[i + 1]].x;
+            if (!antialias) {
+                // Pixels whose centers fall in the span, at full precision
+                const int64_t one = (int64_t)FIXED_ONE * 65536;
+                int px0 = floorDiv(xa - one / 2 + one - 1, one);
+                int px1 = floorDiv(xb - one / 2 + one - 1, one);
+                if (px0 < area.x) px0 = area.x;
+                if (px1 > area.x + area.w) px1 = area.x + area.w;
+                if (px1 > px0) renderer.fillRow(px0, py, px1 - px0, color);
+                continue;
+            }
+            
+            // Span between this crossing and the next, in 24.8
+            xa = floorDiv(xa, 65536);
+            xb = floorDiv(xb, 65536);
+            if (xa < clipLeft) xa = clipLeft;
+            if (xb > clipRight) xb = clipRight;
+            if (xa >= xb) continue;
+            
+            int a = (int)(xa - clipLeft);
+            int b = (int)(xb - clipLeft);
+            int p0 = a / FIXED_ONE;
+            int p1 = b / FIXED_ONE;
+            if (p0 == p1) {
+                cover[p0] += b - a;
+            } else {
+                cover[p0] += FIXED_ONE - a % FIXED_ONE;
+                carry[p0 + 1] += FIXED_ONE;
+                carry[p1] -= FIXED_ONE;
+                cover[p1] += b % FIXED_ONE;
+            }
+            if (p0 < touchedMin) touchedMin = p0;
+            if (p1 > touchedMax) touchedMax = p1;
+        }
+        
+        // Last sample row of a pixel row: resolve and draw what it gathered
+        if (!antialias || (s + 1) % samples != 0 || touchedMax < touchedMin) continue;
+        
+        if (touchedMax >= area.w) touchedMax = area.w - 1;
+        int32_t running = 0;
+        for (int chunk = touchedMin; chunk <= touchedMax; chunk += SPAN_CHUNK) {
+            int n = touchedMax + 1 - chunk;
+            if (n > SPAN_CHUNK) n = SPAN_CHUNK;
+            
+            for (int i = 0; i < n; i++) {
+                running += carry[chunk + i];
+                int32_t sum = cover[chunk + i] + running;
+                cover[chunk + i] = 0;
+                carry[chunk + i] = 0;
+                // A pixel's full coverage is FIXED_ONE per sample row
+                uint32_t c = (uint32_t)(sum * 255 + FIXED_ONE * AA_SUBPIXEL / 2) /
+                             (FIXED_ONE * AA_SUBPIXEL);
+                coverage[i] = c > 255 ? 255 : (uint8_t)c;
+            }
+            emitCoverage(renderer, area.x + chunk, py, coverage, n, color);
+        }
+        cover[area.w] = 0;
+        carry[area.w] = 0;
+        touchedMin = area.w;
+        touchedMax = -1;
+    }
+}
+
+void GfxEffects::fillTriangle(Renderer& renderer, FixedPoint a, FixedPoint b, FixedPoint c,
+                              Renderer::Color color, bool antialias) {
+    FixedPoint points[3] = {a, b, c};
+    fillPolygon(renderer, points, 3, color, FILL_NONZERO, antialias);
+}
+
+// ============================================================
+// PATHS
+// ============================================================
+
+// Accumulation for fills, w + 2 entries per row; aa_path_fill takes as
+// many rows as fit and bands taller paths, so wide paths just get shorter
+// bands. Paths wider than it holds are not drawn.
+static const int PATH_ACCUM = 16384;    // 64 KB
+static int32_t s_pathAccum[PATH_ACCUM];
+
+GfxEffects::Path::Path(int capacity) : m_lines(new aa_line_t[capacity]) {
+    aa_path_init(&m_path, m_lines, m_lines ? capacity : 0);
+}
+
+GfxEffects::Path::~Path() {
+    delete[] m_lines;
+}
+
+void GfxEffects::Path::reset() {
+    aa_path_reset(&m_path);
+}
+
+void GfxEffects::Path::moveTo(FixedPoint p) {
+    aa_path_move_to(&m_path, p.x, p.y);
+}
+
+void GfxEffects::Path::lineTo(FixedPoint p) {
+    aa_path_line_to(&m_path, p.x, p.y);
+}
+
+void GfxEffects::Path::quadTo(FixedPoint control, FixedPoint p) {
+    aa_path_quad_to(&m_path, control.x, control.y, p.x, p.y);
+}
+
+void GfxEffects::Path::arc(FixedPoint center, int32_t radius, int32_t start, int32_t sweep) {
+    aa_path_arc(&m_path, center.x, center.y, radius, start, sweep);
+}
+
+void GfxEffects::Path::close() {
+    aa_path_close(&m_path);
+}
+
+struct PathPaint {
+    Renderer* renderer;
+    Renderer::Color color;
+};
+
+static void paintPathSpan(void* ctx, int32_t x, int32_t y, const uint8_t* coverage, int32_t count) {
+    PathPaint* paint = (PathPaint*)ctx;
+    emitCoverage(*paint->renderer, x, y, coverage, count, paint->color);
+}
+
+void GfxEffects::fillPath(Renderer& renderer, const Path& path, Renderer::Color color) {
+    if (color.a == 0) return;
     
-    // Fill center rectangles
-    renderer.drawFilledRectangle(x + radius, y, width - radius * 2, height, color);
-    renderer.drawFilledRectangle(x, y + radius, radius, height - radius * 2, color);
-    renderer.drawFilledRectangle(x + width - radius, y + radius, radius, height - radius * 2, color);
+    int32_t x, y, w, h;
+    aa_path_bounds(&path.m_path, &x, &y, &w, &h);
+    Renderer::Rect area = renderer.markDamage(x, y, w, h);
+    if (area.w == 0 || area.w + 2 > PATH_ACCUM) return;
     
-    // Four corners with anti-aliasing
-    aaCircle(renderer, x + radius, y + radius, radius, color);
-    aaCircle(renderer, x + width - radius - 1, y + radius, radius, color);
-    aaCircle(renderer, x + radius, y + height - radius - 1, radius, color);
-    aaCircle(renderer, x + width - radius - 1, y + height - radius - 1, radius, color);
+    PathPaint paint = {&renderer, color};
+    aa_path_fill(&path.m_path, area.x, area.y, area.w, area.h, s_pathAccum, PATH_ACCUM,
+                 paintPathSpan, &paint);
 }
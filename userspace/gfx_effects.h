@@ -2,6 +2,7 @@
 #define GFX_EFFECTS_H
 
 #include "renderer.h"
+#include "aa_path.h"
 #include <stdint.h>
 
 class GfxEffects {
@@ -13,16 +14,114 @@ public:
     static void dropShadow(Renderer& renderer, int x, int y, int width, int height, 
                           int offsetX, int offsetY, int blur, Renderer::Color color);
     
-    // Smooth gradient (horizontal/vertical)
+    // Smooth gradient (horizontal/vertical); repeated calls reuse a cached strip
     static void gradient(Renderer& renderer, int x, int y, int width, int height,
                         Renderer::Color c1, Renderer::Color c2, bool horizontal);
     
     // Anti-aliased circle
     static void aaCircle(Renderer& renderer, int cx, int cy, int radius, Renderer::Color color);
     
-    // Anti-aliased rounded rectangle
+    // Rounded rectangle corner radii, clockwise from the top left
+    struct CornerRadii {
+        int topLeft, topRight, bottomRight, bottomLeft;
+        
+        CornerRadii(int radius)
+            : topLeft(radius), topRight(radius), bottomRight(radius), bottomLeft(radius) {}
+        CornerRadii(int tl, int tr, int br, int bl)
+            : topLeft(tl), topRight(tr), bottomRight(br), bottomLeft(bl) {}
+    };
+    
+    // Anti-aliased rounded rectangle; outlines are one pixel wide
     static void aaRoundedRect(Renderer& renderer, int x, int y, int width, int height,
                              int radius, Renderer::Color color, bool filled);
+    
+    // Anti-aliased rounded rectangles with per-corner radii. Solid interior
+    // runs are filled and only corner pixels get coverage, so translucent
+    // colors blend each pixel exactly once. Strokes grow inward.
+    static void fillRoundedRect(Renderer& renderer, int x, int y, int width, int height,
+                                const CornerRadii& radii, Renderer::Color color);
+    static void strokeRoundedRect(Renderer& renderer, int x, int y, int width, int height,
+                                  const CornerRadii& radii, int strokeWidth,
+                                  Renderer::Color color);
+    
+    // Polyline vertex; like circle centers, a point is a pixel's center
+    struct Point {
+        int x, y;
+    };
+    
+    enum LineJoin {
+        JOIN_ROUND,           // Round joins and caps
+        JOIN_MITER            // Miter joins, beveled past 4:1, and butt caps
+    };
+    
+    // One pixel wide anti-aliased line (Wu)
+    static void aaLine(Renderer& renderer, int x0, int y0, int x1, int y1, Renderer::Color color);
+    
+    // Thick anti-aliased polyline. The whole stroke gets one coverage value
+    // per pixel, so translucent strokes do not darken where segments meet.
+    static void aaPolyline(Renderer& renderer, const Point* points, int count, int width,
+                           Renderer::Color color, LineJoin join = JOIN_ROUND);
+    
+    // Polygon vertex in 24.8 fixed point. Whole numbers are pixel corners,
+    // so a square through (0, 0) and (4, 4) covers 16 pixels, and shapes
+    // can move by fractions of a pixel.
+    static const int FIXED_SHIFT = 8;
+    
+    struct FixedPoint {
+        int32_t x, y;
+    };
+    
+    static FixedPoint fixedPoint(int x, int y) {
+        return FixedPoint{x * (1 << FIXED_SHIFT), y * (1 << FIXED_SHIFT)};
+    }
+    
+    enum FillRule {
+        FILL_NONZERO,         // Inside where contours wind around a point
+        FILL_EVENODD          // Inside where a ray crosses an odd number of edges
+    };
+    
+    // Filled polygon, implicitly closed, scan converted with an active
+    // edge table. Interior runs go to fillRow whole; anti-aliased edges
+    // get exact horizontal coverage on 16 sample rows per pixel. Polygons
+    // of more than 1024 points are not drawn.
+    static void fillPolygon(Renderer& renderer, const FixedPoint* points, int count,
+                            Renderer::Color color, FillRule rule = FILL_NONZERO,
+                            bool antialias = true);
+    static void fillTriangle(Renderer& renderer, FixedPoint a, FixedPoint b, FixedPoint c,
+                             Renderer::Color color, bool antialias = true);
+    
+    // Vector path in the same fixed point space, flattened to segments as
+    // it is built. Segment storage is allocated once, so keep a path and
+    // reset() it rather than making one per frame. Angles are ANGLE_TURN
+    // units per turn, zero along +x and growing clockwise.
+    class Path {
+    public:
+        static const int32_t ANGLE_TURN = AA_ANGLE_TURN;
+        
+        // Segments past capacity are dropped and overflowed() turns true
+        explicit Path(int capacity);
+        ~Path();
+        
+        void reset();
+        void moveTo(FixedPoint p);
+        void lineTo(FixedPoint p);
+        void quadTo(FixedPoint control, FixedPoint p);
+        void arc(FixedPoint center, int32_t radius, int32_t start, int32_t sweep);
+        void close();
+        
+        bool overflowed() const { return m_path.overflow != 0; }
+        
+    private:
+        friend class GfxEffects;
+        
+        aa_line_t* m_lines;
+        aa_path_t m_path;
+    };
+    
+    // Anti-aliased non-zero fill of a path, with exact area coverage from
+    // one accumulation sweep; open contours are closed
+    static void fillPath(Renderer& renderer, const Path& path, Renderer::Color color);
+    
 private:
     static uint8_t smoothstep(float edge0, float edge1, float x);
 };
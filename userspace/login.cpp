@@ -23,7 +23,8 @@ void LoginManager::render() {
     m_renderer.drawFilledCircle(centerX, centerY - 120, 15, Renderer::Color(6, 182, 212));
     
     // "HACOS" text
-    m_fontRenderer.drawTextCentered(centerY - 40, "HACOS", Renderer::Color(6, 182, 212), 2);
+    m_fontRenderer.drawSmoothTextCentered(centerY - 40, "HACOS", Renderer::Color(6, 182, 212),
+                                          2 * FontRenderer::SCALE_ONE);
     
     // Password dots
     if (m_passwordLen > 0) {
@@ -42,6 +43,8 @@ void LoginManager::render() {
     // Instructions
     m_fontRenderer.drawTextCentered(m_renderer.height() - 50, "PRESS ENTER TO LOGIN", 
                                    Renderer::Color(96, 96, 96), 1);
+    
+    m_fontRenderer.present();
 }
 
 bool LoginManager::run() {
@@ -55,9 +58,11 @@ bool LoginManager::run() {
                 // Success animation
                 for (int i = 0; i < 30; i++) {
                     m_renderer.clear(Renderer::Color(5, 8, 16));
-                    m_fontRenderer.drawTextCentered(m_renderer.height() / 2, 
-                                                   "ACCESS GRANTED", 
-                                                   Renderer::Color(6, 182, 212), 2);
+                    m_fontRenderer.drawSmoothTextCentered(m_renderer.height() / 2, 
+                                                         "ACCESS GRANTED", 
+                                                         Renderer::Color(6, 182, 212),
+                                                         2 * FontRenderer::SCALE_ONE);
+                    m_fontRenderer.present();
                     delay_ms(33);
                 }
                 return true;
@@ -1,5 +1,7 @@
 #include "renderer.h"
+#include "display_list.h"
 #include "input_manager.h"
+#include "login_screen.h"
 #include <cstring>
 
 extern "C" {
@@ -7,56 +9,76 @@ extern "C" {
     uint64_t get_ticks();
 }
 
+// Input field redraw: restore, up to 63 dots or the placeholder, cursor
+static const int FIELD_COMMANDS = 66;
+
+static LoginFrameStats s_frameStats = {{0, 0, 0}, 0, 0, 0};
+
+static void keepFrameStats(const DisplayList& list) {
+    s_frameStats.pixels = list.frameStats();
+    s_frameStats.overdrawPercent = list.overdrawPercent();
+    s_frameStats.commands = list.size();
+    s_frameStats.culled = list.culledCount();
+}
+
+const LoginFrameStats& loginFrameStats() {
+    return s_frameStats;
+}
+
 // Draw large "Welcome" text
 // Draw "Welcome" text - cleaner and larger
-void drawWelcomeText(Renderer& r, int x, int y) {
+void drawWelcomeText(DisplayList& r, int x, int y) {
     Renderer::Color textColor(150, 210, 255);
     int charWidth = 20;
     int charHeight = 40;
     
     // W - two vertical lines with peak
-    r.drawFilledRectangle(x, y, 6, charHeight, textColor);
-    r.drawFilledRectangle(x + 7, y + 15, 6, charHeight - 15, textColor);
-    r.drawFilledRectangle(x + 14, y + 15, 6, charHeight - 15, textColor);
-    r.drawFilledRectangle(x + 21, y, 6, charHeight, textColor);
+    r.fillRect(x, y, 6, charHeight, textColor);
+    r.fillRect(x + 7, y + 15, 6, charHeight - 15, textColor);
+    r.fillRect(x + 14, y + 15, 6, charHeight - 15, textColor);
+    r.fillRect(x + 21, y, 6, charHeight, textColor);
     
     // e
-    r.drawFilledRectangle(x + 40, y, 20, 6, textColor);      // top
-    r.drawFilledRectangle(x + 40, y + 17, 20, 6, textColor); // middle
-    r.drawFilledRectangle(x + 40, y + 34, 20, 6, textColor); // bottom
-    r.drawFilledRectangle(x + 40, y, 6, charHeight, textColor); // left
+    r.fillRect(x + 40, y, 20, 6, textColor);      // top
+    r.fillRect(x + 40, y + 17, 20, 6, textColor); // middle
+    r.fillRect(x + 40, y + 34, 20, 6, textColor); // bottom
+    r.fillRect(x + 40, y, 6, charHeight, textColor); // left
     
     // l
-    r.drawFilledRectangle(x + 75, y, 6, charHeight, textColor);
+    r.fillRect(x + 75, y, 6, charHeight, textColor);
     
     // c
-    r.drawFilledRectangle(x + 95, y, 6, charHeight, textColor);   // left line
-    r.drawFilledRectangle(x + 95, y, 16, 6, textColor);           // top
-    r.drawFilledRectangle(x + 95, y + charHeight - 6, 16, 6, textColor); // bottom
+    r.fillRect(x + 95, y, 6, charHeight, textColor);   // left line
+    r.fillRect(x + 95, y, 16, 6, textColor);           // top
+    r.fillRect(x + 95, y + charHeight - 6, 16, 6, textColor); // bottom
     
     // o
-    r.drawFilledRectangle(x + 125, y, 6, charHeight, textColor);  // left
-    r.drawFilledRectangle(x + 145, y, 6, charHeight, textColor);  // right
-    r.drawFilledRectangle(x + 125, y, 26, 6, textColor);          // top
-    r.drawFilledRectangle(x + 125, y + charHeight - 6, 26, 6, textColor); // bottom
+    r.fillRect(x + 125, y, 6, charHeight, textColor);  // left
+    r.fillRect(x + 145, y, 6, charHeight, textColor);  // right
+    r.fillRect(x + 125, y, 26, 6, textColor);          // top
+    r.fillRect(x + 125, y + charHeight - 6, 26, 6, textColor); // bottom
     
     // m
-    r.drawFilledRectangle(x + 165, y, 6, charHeight, textColor);  // left
-    r.drawFilledRectangle(x + 177, y, 6, 20, textColor);          // middle peak
-    r.drawFilledRectangle(x + 189, y, 6, charHeight, textColor);  // right
-    r.drawFilledRectangle(x + 165, y + 20, 30, 6, textColor);     // baseline
+    r.fillRect(x + 165, y, 6, charHeight, textColor);  // left
+    r.fillRect(x + 177, y, 6, 20, textColor);          // middle peak
+    r.fillRect(x + 189, y, 6, charHeight, textColor);  // right
+    r.fillRect(x + 165, y + 20, 30, 6, textColor);     // baseline
     
     // e (second)
-    r.drawFilledRectangle(x + 210, y, 20, 6, textColor);          // top
-    r.drawFilledRectangle(x + 210, y + 17, 20, 6, textColor);     // middle
-    r.drawFilledRectangle(x + 210, y + 34, 20, 6, textColor);     // bottom
-    r.drawFilledRectangle(x + 210, y, 6, charHeight, textColor);  // left
+    r.fillRect(x + 210, y, 20, 6, textColor);          // top
+    r.fillRect(x + 210, y + 17, 20, 6, textColor);     // middle
+    r.fillRect(x + 210, y + 34, 20, 6, textColor);     // bottom
+    r.fillRect(x + 210, y, 6, charHeight, textColor);  // left
 }
 
 
-bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height, uint32_t pitch) {
+bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height, uint32_t pitch,
+                    bool backBuffer) {
     Renderer renderer(framebuffer, width, height, pitch);
+    if (backBuffer) renderer.enableBackBuffer();
     InputManager input;
+    DisplayList card(64, height);
+    DisplayList field(FIELD_COMMANDS, height);
     
     char password[64] = {0};
     int passwordLen = 0;
@@ -64,6 +86,10 @@ bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height, uint
     bool authenticated = false;
     bool firstFrame = true;
     
+    // What the input field currently shows on screen
+    int shownPasswordLen = -1;
+    bool shownCursor = false;
+    
     Renderer::Color bgDark(15, 15, 22);
     Renderer::Color accentColor(100, 180, 255);
     Renderer::Color accentBright(150, 210, 255);
@@ -85,6 +111,10 @@ bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height, uint
     int btnW = inputW;
     int btnH = 65;
     
+    // The card never changes: it is rasterized once into its own layer,
+    // composited with one blit, and the layer restores the input field
+    Surface cardLayer(panelW, panelH);
+    
     while (!authenticated) {
         // INPUT
         input.update();
@@ -105,72 +135,89 @@ bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height, uint
             }
         }
         
-        // RENDER - only on first frame or on changes
+        // RENDER - background and card are drawn once; afterwards only
+        // the input field changes
         if (firstFrame) {
-            renderer.clear(bgDark);
-            firstFrame = false;
-        }
-        
-        // Card (only draw once, not every frame)
-        static bool cardDrawn = false;
-        if (!cardDrawn) {
-            renderer.drawFilledRectangle(panelX, panelY, panelW, panelH, panelBg);
+            card.fillRect(panelX, panelY, panelW, panelH, panelBg);
             
             // Border
-            renderer.drawFilledRectangle(panelX, panelY, panelW, 2, accentColor);
-            renderer.drawFilledRectangle(panelX, panelY + panelH - 2, panelW, 2, accentColor);
-            renderer.drawFilledRectangle(panelX, panelY, 2, panelH, accentColor);
-            renderer.drawFilledRectangle(panelX + panelW - 2, panelY, 2, panelH, accentColor);
+            card.fillRect(panelX, panelY, panelW, 2, accentColor);
+            card.fillRect(panelX, panelY + panelH - 2, panelW, 2, accentColor);
+            card.fillRect(panelX, panelY, 2, panelH, accentColor);
+            card.fillRect(panelX + panelW - 2, panelY, 2, panelH, accentColor);
             
             // Welcome text area
-            renderer.drawFilledRectangle(panelX + 50, panelY + 50, 540, 100, Renderer::Color(35, 42, 60));
-            drawWelcomeText(renderer, panelX + 200, panelY + 65);
+            card.fillRect(panelX + 50, panelY + 50, 540, 100, Renderer::Color(35, 42, 60));
+            drawWelcomeText(card, panelX + 200, panelY + 65);
             
             // Decorative line
-            renderer.drawFilledRectangle(panelX + 120, panelY + 175, panelW - 240, 2, accentColor);
+            card.fillRect(panelX + 120, panelY + 175, panelW - 240, 2, accentColor);
             
             // Password input border
-            renderer.drawFilledRectangle(inputX - 2, inputY - 2, inputW + 4, inputH + 4, accentColor);
-            renderer.drawFilledRectangle(inputX, inputY, inputW, inputH, inputBg);
+            card.fillRect(inputX - 2, inputY - 2, inputW + 4, inputH + 4, accentColor);
+            card.fillRect(inputX, inputY, inputW, inputH, inputBg);
             
             // Button
-            renderer.drawFilledRectangle(btnX, btnY, btnW, btnH, accentColor);
-            renderer.drawFilledRectangle(btnX, btnY, btnW, 2, accentBright);
+            card.fillRect(btnX, btnY, btnW, btnH, accentColor);
+            card.fillRect(btnX, btnY, btnW, 2, accentBright);
             
             // Arrow
             int arrowX = btnX + btnW / 2;
             int arrowY = btnY + btnH / 2;
-            renderer.drawFilledRectangle(arrowX - 16, arrowY - 2, 32, 4, Renderer::Color(255, 255, 255));
-            for (int i = 0; i < 6; i++) {
-                renderer.drawFilledRectangle(arrowX + 12 - i, arrowY - 4 + i, 1, 1, Renderer::Color(255, 255, 255));
-                renderer.drawFilledRectangle(arrowX + 12 - i, arrowY + 4 - i, 1, 1, Renderer::Color(255, 255, 255));
-            }
+            card.fillRect(arrowX - 16, arrowY - 2, 32, 4, Renderer::Color(255, 255, 255));
+            card.line(arrowX + 8, arrowY - 7, arrowX + 15, arrowY, 3, Renderer::Color(255, 255, 255));
+            card.line(arrowX + 15, arrowY, arrowX + 8, arrowY + 7, 3, Renderer::Color(255, 255, 255));
             
-            cardDrawn = true;
+            renderer.clear(bgDark);
+            if (cardLayer.valid()) {
+                Renderer layer(cardLayer);
+                card.replay(layer, -panelX, -panelY);
+                renderer.blit(cardLayer, panelX, panelY);
+            } else {
+                card.replay(renderer);
+            }
+            keepFrameStats(card);
+            firstFrame = false;
         }
         
-        // Draw password dots (changes every frame)
-        renderer.drawFilledRectangle(inputX + 10, inputY + 10, inputW - 20, inputH - 20, inputBg);
+        // Password dots and cursor blink. Only redrawn when they change,
+        // so idle frames leave no damage and present() copies nothing.
+        cursorBlink = (cursorBlink + 1) % 60;
+        bool cursorOn = cursorBlink < 30 && passwordLen > 0;
         
-        if (passwordLen > 0) {
-            int dotSize = 8;
-            int dotSpacing = 24;
-            int totalWidth = passwordLen * dotSpacing;
-            int startX = inputX + (inputW - totalWidth) / 2;
+        if (passwordLen != shownPasswordLen || cursorOn != shownCursor) {
+            field.reset();
+            if (cardLayer.valid()) {
+                Renderer::Rect area{inputX + 10 - panelX, inputY + 10 - panelY, inputW - 20, inputH - 20};
+                renderer.blitRect(cardLayer, area, inputX + 10, inputY + 10);
+            } else {
+                field.fillRect(inputX + 10, inputY + 10, inputW - 20, inputH - 20, inputBg);
+            }
+            
+            if (passwordLen > 0) {
+                int dotSize = 8;
+                int dotSpacing = 24;
+                int totalWidth = passwordLen * dotSpacing;
+                int startX = inputX + (inputW - totalWidth) / 2;
+                
+                for (int i = 0; i < passwordLen; i++) {
+                    field.fillCircle(startX + i * dotSpacing, inputY + inputH / 2, dotSize, accentBright);
+                }
+            } else {
+                field.fillRect(inputX + 20, inputY + inputH / 2 - 2, 100, 4, Renderer::Color(100, 120, 150));
+            }
             
-            for (int i = 0; i < passwordLen; i++) {
-                renderer.drawFilledCircle(startX + i * dotSpacing, inputY + inputH / 2, dotSize, accentBright);
+            if (cursorOn) {
+                field.fillRect(inputX + inputW - 30, inputY + 15, 2, inputH - 30, accentBright);
             }
-        } else {
-            renderer.drawFilledRectangle(inputX + 20, inputY + inputH / 2 - 2, 100, 4, Renderer::Color(100, 120, 150));
-        }
-        
-        // Cursor blink (changes every frame)
-        cursorBlink = (cursorBlink + 1) % 60;
-        if (cursorBlink < 30 && passwordLen > 0) {
-            renderer.drawFilledRectangle(inputX + inputW - 30, inputY + 15, 2, inputH - 30, accentBright);
+            
+            field.replay(renderer);
+            keepFrameStats(field);
+            shownPasswordLen = passwordLen;
+            shownCursor = cursorOn;
         }
         
+        renderer.present();
         delay_ms(16);
     }
     
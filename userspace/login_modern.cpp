@@ -1,13 +1,19 @@
 #include "login_modern.h"
 #include "gfx_effects.h"
 
+// Not part of the build: USERSPACE_OBJS links login_consumer.cpp's
+// runLoginScreen, and nothing creates a ModernLogin. This screen is kept
+// compiling, but none of it runs at boot.
+
 extern "C" {
     void delay_ms(int ms);
 }
 
 ModernLogin::ModernLogin(Renderer& renderer, FontRenderer& fontRenderer, InputManager& input)
-    : m_renderer(renderer), m_fontRenderer(fontRenderer), m_input(input),
-      m_passwordLen(0), m_inputFocused(false), m_animFrame(0) {
+    : m_renderer(renderer), m_fontRenderer(fontRenderer), m_input(input), m_logoPath(256),
+      m_passwordLen(0), m_inputFocused(false), m_animFrame(0),
+      m_hasRendered(false), m_renderedGlowStep(0), m_renderedCoreStep(0),
+      m_renderedPasswordLen(0), m_renderedHovered(false) {
     
     for (int i = 0; i < 64; i++) m_password[i] = 0;
     
@@ -27,29 +33,53 @@ ModernLogin::ModernLogin(Renderer& renderer, FontRenderer& fontRenderer, InputMa
     m_buttonY = m_centerY + 120;
 }
 
-void ModernLogin::renderLogo(int frame) {
-    // Animated pulsing logo
+static int logoPulse(int frame) {
     int pulse = (frame % 120);
     if (pulse > 60) pulse = 120 - pulse;
+    return pulse;
+}
+
+void ModernLogin::renderLogo(int frame) {
+    // Animated pulsing logo
+    int pulse = logoPulse(frame);
     
     int baseRadius = 50;
     int glowRadius = baseRadius + pulse / 10;
     
-    // Outer glow rings
+    // Rings are paths around the center pixel's center. As with aaCircle,
+    // edges sit half a pixel past the radius.
+    const int32_t one = 1 << GfxEffects::FIXED_SHIFT;
+    const int32_t turn = GfxEffects::Path::ANGLE_TURN;
+    GfxEffects::FixedPoint center = GfxEffects::fixedPoint(m_centerX, m_centerY - 150);
+    center.x += one / 2;
+    center.y += one / 2;
+    
+    // Outer glow, one band per pixel of radius outside the ring, each as
+    // opaque as the stack of glow discs over it once was
+    int glowAlpha = 0;
     for (int r = glowRadius; r > baseRadius; r--) {
         int alpha = ((glowRadius - r) * 40) / (glowRadius - baseRadius);
-        GfxEffects::aaCircle(m_renderer, m_centerX, m_centerY - 150, r, 
-                           Renderer::Color(6, 182, 212, alpha));
+        glowAlpha += alpha * (255 - glowAlpha) / 255;
+        if (glowAlpha == 0) continue;
+        
+        m_logoPath.reset();
+        m_logoPath.arc(center, r * one + one / 2, 0, turn);
+        m_logoPath.close();
+        m_logoPath.arc(center, r * one - one / 2, 0, -turn);
+        GfxEffects::fillPath(m_renderer, m_logoPath, Renderer::Color(6, 182, 212, glowAlpha));
     }
     
-    // Main ring (anti-aliased)
-    GfxEffects::aaCircle(m_renderer, m_centerX, m_centerY - 150, baseRadius, 
-                        Renderer::Color(6, 182, 212));
-    
-    // Inner core (filled, pulsing)
+    // Main ring and the pulsing core inside it, one path. The ring's inner
+    // contour winds the other way, so the gap between them stays open.
     int coreRadius = 20 + (pulse / 15);
-    GfxEffects::aaCircle(m_renderer, m_centerX, m_centerY - 150, coreRadius, 
-                        Renderer::Color(6, 182, 212));
+    m_logoPath.reset();
+    m_logoPath.arc(center, baseRadius * one + one / 2, 0, turn);
+    m_logoPath.close();
+    m_logoPath.arc(center, (baseRadius - 4) * one + one / 2, 0, -turn);
+    m_logoPath.close();
+    m_logoPath.arc(center, coreRadius * one + one / 2, 0, turn);
+    m_logoPath.close();
+    GfxEffects::fillPath(m_renderer, m_logoPath, Renderer::Color(6, 182, 212));
 }
 
 void ModernLogin::renderInputField(bool focused) {
@@ -57,7 +87,8 @@ void ModernLogin::renderInputField(bool focused) {
     GfxEffects::dropShadow(m_renderer, m_inputX, m_inputY, m_inputW, m_inputH,
                           0, 4, 12, Renderer::Color(0, 0, 0, 100));
     
-    // Glassmorphism background (semi-transparent dark)
+    // Glassmorphism background: frosted backdrop, then a dark tint
+    GfxEffects::blur(m_renderer, m_inputX, m_inputY, m_inputW, m_inputH, 12);
     Renderer::Color bgColor = Renderer::Color(25, 30, 45, 200);
     GfxEffects::aaRoundedRect(m_renderer, m_inputX, m_inputY, m_inputW, m_inputH,
                               12, bgColor, true);
@@ -66,21 +97,9 @@ void ModernLogin::renderInputField(bool focused) {
     Renderer::Color borderColor = focused ?
         Renderer::Color(6, 182, 212) : Renderer::Color(60, 70, 90);
     
-    // Draw 2px border
-    for (int i = 0; i < 2; i++) {
-        // Top
-        m_renderer.drawFilledRectangle(m_inputX + 12, m_inputY + i, 
-                                      m_inputW - 24, 1, borderColor);
-        // Bottom
-        m_renderer.drawFilledRectangle(m_inputX + 12, m_inputY + m_inputH - i - 1, 
-                                      m_inputW - 24, 1, borderColor);
-        // Left
-        m_renderer.drawFilledRectangle(m_inputX + i, m_inputY + 12, 
-                                      1, m_inputH - 24, borderColor);
-        // Right
-        m_renderer.drawFilledRectangle(m_inputX + m_inputW - i - 1, m_inputY + 12, 
-                                      1, m_inputH - 24, borderColor);
-    }
+    // 2px border, corners included
+    GfxEffects::strokeRoundedRect(m_renderer, m_inputX, m_inputY, m_inputW, m_inputH,
+                                  12, 2, borderColor);
     
     // Focused glow effect (outer halo)
     if (focused) {
@@ -88,22 +107,9 @@ void ModernLogin::renderInputField(bool focused) {
             int alpha = 20 - i * 5;
             int offset = i + 2;
             
-            // Top glow
-            m_renderer.drawFilledRectangle(m_inputX + 12 - offset, m_inputY - offset,
-                                          m_inputW - 24 + offset * 2, 1,
-                                          Renderer::Color(6, 182, 212, alpha));
-            // Bottom glow
-            m_renderer.drawFilledRectangle(m_inputX + 12 - offset, m_inputY + m_inputH + offset,
-                                          m_inputW - 24 + offset * 2, 1,
-                                          Renderer::Color(6, 182, 212, alpha));
-            // Left glow
-            m_renderer.drawFilledRectangle(m_inputX - offset, m_inputY + 12 - offset,
-                                          1, m_inputH - 24 + offset * 2,
-                                          Renderer::Color(6, 182, 212, alpha));
-            // Right glow
-            m_renderer.drawFilledRectangle(m_inputX + m_inputW + offset, m_inputY + 12 - offset,
-                                          1, m_inputH - 24 + offset * 2,
-                                          Renderer::Color(6, 182, 212, alpha));
+            GfxEffects::strokeRoundedRect(m_renderer, m_inputX - offset, m_inputY - offset,
+                                          m_inputW + offset * 2 + 1, m_inputH + offset * 2 + 1,
+                                          12 + offset, 1, Renderer::Color(6, 182, 212, alpha));
         }
     }
 }
@@ -169,19 +175,64 @@ void ModernLogin::renderButton(bool hovered) {
     int arrowX = m_centerX;
     int arrowY = m_buttonY + m_buttonH / 2;
     
-    // Arrow shaft (thicker, anti-aliased)
+    // Arrow shaft
     m_renderer.drawFilledRectangle(arrowX - 18, arrowY - 2, 36, 4, 
                                   Renderer::Color(255, 255, 255));
     
-    // Arrow head (cleaner triangle)
-    for (int i = 0; i < 10; i++) {
-        int y1 = arrowY - 6 + i;
-        int y2 = arrowY + 6 - i;
-        m_renderer.drawFilledRectangle(arrowX + 12 + i, y1, 2, 1, 
-                                      Renderer::Color(255, 255, 255));
-        m_renderer.drawFilledRectangle(arrowX + 12 + i, y2, 2, 1, 
-                                      Renderer::Color(255, 255, 255));
+    // Arrow head, one mitered stroke
+    GfxEffects::Point head[3] = {{arrowX + 10, arrowY - 8}, {arrowX + 19, arrowY},
+                                 {arrowX + 10, arrowY + 8}};
+    GfxEffects::aaPolyline(m_renderer, head, 3, 4, Renderer::Color(255, 255, 255),
+                           GfxEffects::JOIN_MITER);
+}
+
+static void addToRegion(Renderer::Rect& region, bool& any, int x, int y, int w, int h) {
+    if (!any) {
+        region = Renderer::Rect{x, y, w, h};
+        any = true;
+        return;
+    }
+    int x1 = region.x + region.w > x + w ? region.x + region.w : x + w;
+    int y1 = region.y + region.h > y + h ? region.y + region.h : y + h;
+    if (x < region.x) region.x = x;
+    if (y < region.y) region.y = y;
+    region.w = x1 - region.x;
+    region.h = y1 - region.y;
+}
+
+bool ModernLogin::dirtyRegion(bool buttonHovered, Renderer::Rect& dirty) {
+    // The logo only changes when its glow or core radius steps
+    int pulse = logoPulse(m_animFrame);
+    int glowStep = pulse / 10;
+    int coreStep = pulse / 15;
+    
+    // Newest password dot is still scaling in
+    bool dotsAnimating = m_passwordLen > 0 &&
+                         m_animFrame - (m_passwordLen - 1) * 3 < 15;
+    
+    bool any = false;
+    if (!m_hasRendered) {
+        addToRegion(dirty, any, 0, 0, m_renderer.width(), m_renderer.height());
+    }
+    if (glowStep != m_renderedGlowStep || coreStep != m_renderedCoreStep) {
+        // Largest glow ring is 56px, aaCircle fades 2px past it
+        addToRegion(dirty, any, m_centerX - 58, m_centerY - 150 - 58, 117, 117);
+    }
+    if (dotsAnimating || m_passwordLen != m_renderedPasswordLen) {
+        // Field plus its drop shadow and focus halo
+        addToRegion(dirty, any, m_inputX - 13, m_inputY - 13, m_inputW + 26, m_inputH + 30);
     }
+    if (buttonHovered != m_renderedHovered) {
+        // Button plus its largest (hovered) drop shadow
+        addToRegion(dirty, any, m_buttonX - 18, m_buttonY - 18, m_buttonW + 36, m_buttonH + 43);
+    }
+    
+    m_hasRendered = true;
+    m_renderedGlowStep = glowStep;
+    m_renderedCoreStep = coreStep;
+    m_renderedPasswordLen = m_passwordLen;
+    m_renderedHovered = buttonHovered;
+    return any;
 }
 
 void ModernLogin::render() {
@@ -226,25 +277,20 @@ void ModernLogin::playSuccessAnimation() {
             int checkSize = (checkFrame * 60) / 35;
             if (checkSize > 60) checkSize = 60;
             
-            // Left part of checkmark
-            int leftLen = checkSize / 2;
-            for (int i = 0; i < leftLen; i++) {
-                for (int t = 0; t < 4; t++) {
-                    GfxEffects::aaCircle(m_renderer, m_centerX - 25 + i, m_centerY + i - t,
-                                       3, Renderer::Color(255, 255, 255));
-                }
-            }
-            
-            // Right part of checkmark
+            // Short arm down to the corner, then the long arm up
+            int leftLen = (checkSize < 30 ? checkSize : 30) / 2;
+            GfxEffects::Point check[3] = {
+                {m_centerX - 25, m_centerY - 2},
+                {m_centerX - 25 + leftLen, m_centerY - 2 + leftLen},
+                {0, 0}
+            };
+            int points = 2;
             if (checkSize > 30) {
                 int rightLen = checkSize - 30;
-                for (int i = 0; i < rightLen; i++) {
-                    for (int t = 0; t < 4; t++) {
-                        GfxEffects::aaCircle(m_renderer, m_centerX - 10 + i, m_centerY + 15 - i - t,
-                                           3, Renderer::Color(255, 255, 255));
-                    }
-                }
+                check[2] = GfxEffects::Point{m_centerX - 10 + rightLen, m_centerY + 13 - rightLen};
+                points = 3;
             }
+            GfxEffects::aaPolyline(m_renderer, check, points, 7, Renderer::Color(255, 255, 255));
         }
         
         // Glow effect behind checkmark
@@ -259,6 +305,7 @@ void ModernLogin::playSuccessAnimation() {
             }
         }
         
+        m_renderer.present();
         delay_ms(20);  // 50fps animation
     }
     
@@ -293,9 +340,16 @@ bool ModernLogin::run() {
             }
         }
         
-        // Animate and redraw
+        // Animate and redraw what changed
         m_animFrame++;
-        render();
+        bool buttonHovered = m_input.isMouseInRect(m_buttonX, m_buttonY, m_buttonW, m_buttonH);
+        Renderer::Rect dirty;
+        if (dirtyRegion(buttonHovered, dirty)) {
+            m_renderer.pushClip(dirty.x, dirty.y, dirty.w, dirty.h);
+            render();
+            m_renderer.popClip();
+        }
+        m_renderer.present();
         
         delay_ms(16);  // ~60fps
     }
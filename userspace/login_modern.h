@@ -2,6 +2,7 @@
 #define LOGIN_MODERN_H
 
 #include "renderer.h"
+#include "gfx_effects.h"
 #include "font_renderer.h"
 #include "input_manager.h"
 
@@ -18,16 +19,28 @@ private:
     void renderPasswordDots();
     void renderButton(bool hovered);
     void playSuccessAnimation();
+    bool dirtyRegion(bool buttonHovered, Renderer::Rect& dirty);
     
     Renderer& m_renderer;
     FontRenderer& m_fontRenderer;
     InputManager& m_input;
     
+    // Logo ring and core, rebuilt as the core pulses
+    GfxEffects::Path m_logoPath;
+    
     char m_password[64];
     int m_passwordLen;
     bool m_inputFocused;
     int m_animFrame;
     
+    // Inputs of the last rendered frame. Only widgets whose inputs changed
+    // are redrawn (under a clip), so a static screen costs nothing.
+    bool m_hasRendered;
+    int m_renderedGlowStep;
+    int m_renderedCoreStep;
+    int m_renderedPasswordLen;
+    bool m_renderedHovered;
+    
     // UI positions
     int m_centerX, m_centerY;
     int m_inputX, m_inputY, m_inputW, m_inputH;
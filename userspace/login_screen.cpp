@@ -1,13 +1,33 @@
 #include "renderer.h"
 #include "input_manager.h"
 #include "gfx_effects.h"
+#include "display_list.h"
+#include "login_screen.h"
+#include "memory.h"
 #include <cstring>
 
+// Not part of the build: this runLoginScreen is an alternative to the one
+// in login_consumer.cpp, which USERSPACE_OBJS links instead. It is kept
+// compiling, but none of it runs at boot.
+
 extern "C" {
     void delay_ms(int ms);
     uint64_t get_ticks();
 }
 
+static LoginFrameStats s_frameStats = {{0, 0, 0}, 0, 0, 0};
+
+static void keepFrameStats(const DisplayList& list) {
+    s_frameStats.pixels = list.frameStats();
+    s_frameStats.overdrawPercent = list.overdrawPercent();
+    s_frameStats.commands = list.size();
+    s_frameStats.culled = list.culledCount();
+}
+
+const LoginFrameStats& loginFrameStats() {
+    return s_frameStats;
+}
+
 // ============================================================
 // CUSTOM MATH - Integer-based, no floats returned
 // ============================================================
@@ -87,14 +107,14 @@ public:
         }
     }
     
-    void render(Renderer& renderer) {
+    void render(DisplayList& frame) {
         for (int i = 0; i < m_count; i++) {
             Particle& p = m_particles[i];
             uint8_t alpha = (uint8_t)(p.life * 200 / 1000);
             Renderer::Color c(6, 182, 212, alpha);
             int r = (int)(p.radius * p.life / 1000);
             if (r > 0) {
-                renderer.drawFilledCircle(p.x / 100, p.y / 100, r, c);
+                frame.fillCircle(p.x / 100, p.y / 100, r, c);
             }
         }
     }
@@ -109,10 +129,22 @@ private:
 // LOGIN SCREEN - Main implementation
 // ============================================================
 
-bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height, uint32_t pitch) {
+// Commands in the worst frame: every particle alive, the logo pulse at
+// its widest (logoScale peaks at 45 rings), a full password, and the
+// fixed gradient, logo, panel, border, field, cursor and button
+static const int MAX_PARTICLES = 256;
+static const int MAX_GLOW_RINGS = 45;
+static const int MAX_PASSWORD_DOTS = 63;
+static const int FIXED_COMMANDS = 17;
+static const int FRAME_COMMANDS = MAX_PARTICLES + MAX_GLOW_RINGS + MAX_PASSWORD_DOTS + FIXED_COMMANDS;
+
+bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height, uint32_t pitch,
+                    bool backBuffer) {
     Renderer renderer(framebuffer, width, height, pitch);
+    if (backBuffer) renderer.enableBackBuffer();
     InputManager input;
-    SimpleParticleSystem particles(256);
+    SimpleParticleSystem particles(MAX_PARTICLES);
+    DisplayList frame(FRAME_COMMANDS, height);
     
     // Input field state
     char password[64] = {0};
@@ -150,7 +182,7 @@ bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height, uint
                 if (passwordLen > 0) {
                     password[--passwordLen] = 0;
                 }
-            } else if (key >= 32 && key < 127 && passwordLen < 63) {
+            } else if (key >= 32 && key < 127 && passwordLen < MAX_PASSWORD_DOTS) {
                 password[passwordLen++] = (char)key;
                 password[passwordLen] = 0;
             }
@@ -183,26 +215,30 @@ bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height, uint
         }
         
         // ========== RENDER ==========
+        // The frame is recorded and replayed in one pass, which skips the
+        // parts of the gradient and glass panel that the opaque input
+        // field and button cover
+        frame.reset();
         
         // Background gradient
-        GfxEffects::gradient(renderer, 0, 0, width, height,
-                           Renderer::Color(5, 8, 16),
-                           Renderer::Color(15, 25, 45), false);
+        frame.gradient(0, 0, width, height,
+                       Renderer::Color(5, 8, 16),
+                       Renderer::Color(15, 25, 45), false);
         
         // Particles
-        particles.render(renderer);
+        particles.render(frame);
         
         // Center logo
         int centerX = width / 2;
         int centerY = height / 2;
         
         // Pulsing logo
-        renderer.drawFilledCircle(centerX, centerY - 120, 50, Renderer::Color(6, 182, 212));
+        frame.fillCircle(centerX, centerY - 120, 50, Renderer::Color(6, 182, 212));
         
         // Glow rings
         for (int r = 50 + logoScale; r > 50; r--) {
             int alpha = ((50 + logoScale - r) * 40) / (logoScale + 1);
-            renderer.drawCircle(centerX, centerY - 120, r, Renderer::Color(6, 182, 212, alpha));
+            frame.circle(centerX, centerY - 120, r, Renderer::Color(6, 182, 212, alpha));
         }
         
         // Glass panel background
@@ -211,19 +247,19 @@ bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height, uint
         int panelW = 480;
         int panelH = 240;
         
-        renderer.drawFilledRectangle(panelX, panelY, panelW, panelH, 
-                                    Renderer::Color(25, 30, 50, 200));
+        frame.fillRect(panelX, panelY, panelW, panelH,
+                       Renderer::Color(25, 30, 50, 200));
         
         // Panel border
         for (int i = 0; i < 2; i++) {
-            renderer.drawFilledRectangle(panelX + i, panelY + i, panelW - i*2, 1, 
-                                        Renderer::Color(6, 182, 212, 150));
-            renderer.drawFilledRectangle(panelX + i, panelY + panelH - i - 1, panelW - i*2, 1, 
-                                        Renderer::Color(6, 182, 212, 150));
-            renderer.drawFilledRectangle(panelX + i, panelY + i, 1, panelH - i*2, 
-                                        Renderer::Color(6, 182, 212, 150));
-            renderer.drawFilledRectangle(panelX + panelW - i - 1, panelY + i, 1, panelH - i*2, 
-                                        Renderer::Color(6, 182, 212, 150));
+            frame.fillRect(panelX + i, panelY + i, panelW - i*2, 1,
+                           Renderer::Color(6, 182, 212, 150));
+            frame.fillRect(panelX + i, panelY + panelH - i - 1, panelW - i*2, 1,
+                           Renderer::Color(6, 182, 212, 150));
+            frame.fillRect(panelX + i, panelY + i, 1, panelH - i*2,
+                           Renderer::Color(6, 182, 212, 150));
+            frame.fillRect(panelX + panelW - i - 1, panelY + i, 1, panelH - i*2,
+                           Renderer::Color(6, 182, 212, 150));
         }
         
         // Input field
@@ -232,12 +268,12 @@ bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height, uint
         int inputW = 360;
         int inputH = 50;
         
-        renderer.drawFilledRectangle(inputX, inputY, inputW, inputH, 
-                                    Renderer::Color(20, 25, 40));
+        frame.fillRect(inputX, inputY, inputW, inputH,
+                       Renderer::Color(20, 25, 40));
         
         // Input border
-        renderer.drawFilledRectangle(inputX, inputY, inputW, 2, Renderer::Color(6, 182, 212));
-        renderer.drawFilledRectangle(inputX, inputY + inputH - 2, inputW, 2, Renderer::Color(6, 182, 212));
+        frame.fillRect(inputX, inputY, inputW, 2, Renderer::Color(6, 182, 212));
+        frame.fillRect(inputX, inputY + inputH - 2, inputW, 2, Renderer::Color(6, 182, 212));
         
         // Password dots
         if (passwordLen > 0) {
@@ -246,16 +282,16 @@ bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height, uint
             int startX = centerX - totalWidth / 2;
             
             for (int i = 0; i < passwordLen; i++) {
-                renderer.drawFilledCircle(startX + i * dotSpacing, inputY + inputH / 2, 5, 
-                                         Renderer::Color(6, 182, 212));
+                frame.fillCircle(startX + i * dotSpacing, inputY + inputH / 2, 5,
+                                 Renderer::Color(6, 182, 212));
             }
         }
         
         // Cursor
         cursorBlink = (cursorBlink + 1) % 60;
         if (cursorBlink < 30) {
-            renderer.drawFilledRectangle(centerX + 150, inputY + 10, 2, inputH - 20, 
-                                        Renderer::Color(6, 182, 212));
+            frame.fillRect(centerX + 150, inputY + 10, 2, inputH - 20,
+                           Renderer::Color(6, 182, 212));
         }
         
         // Login button
@@ -264,17 +300,23 @@ bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height, uint
         int btnW = 160;
         int btnH = 45;
         
-        renderer.drawFilledRectangle(btnX, btnY, btnW, btnH, Renderer::Color(6, 182, 212));
+        frame.fillRect(btnX, btnY, btnW, btnH, Renderer::Color(6, 182, 212));
         
         // Arrow on button
         int arrowX = centerX;
         int arrowY = btnY + btnH / 2;
-        renderer.drawFilledRectangle(arrowX - 12, arrowY - 2, 24, 4, Renderer::Color(255, 255, 255));
-        for (int i = 0; i < 6; i++) {
-            renderer.drawFilledRectangle(arrowX + 8 - i, arrowY - 4 + i, 1, 1, Renderer::Color(255, 255, 255));
-            renderer.drawFilledRectangle(arrowX + 8 - i, arrowY + 4 - i, 1, 1, Renderer::Color(255, 255, 255));
-        }
+        frame.fillRect(arrowX - 12, arrowY - 2, 16, 4, Renderer::Color(255, 255, 255));
+        
+        frame.replay(renderer);
+        keepFrameStats(frame);
+        
+        // The arrow head has no display list command and is drawn last
+        GfxEffects::fillTriangle(renderer, GfxEffects::fixedPoint(arrowX + 2, arrowY - 7),
+                                 GfxEffects::fixedPoint(arrowX + 13, arrowY),
+                                 GfxEffects::fixedPoint(arrowX + 2, arrowY + 7),
+                                 Renderer::Color(255, 255, 255));
         
+        renderer.present();
         delay_ms(1);
     }
     
@@ -294,6 +336,7 @@ bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height, uint
             renderer.drawCircle(centerX, centerY, radius, Renderer::Color(6, 182, 212, alpha));
         }
         
+        renderer.present();
         delay_ms(16);
     }
     
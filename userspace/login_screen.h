@@ -1,8 +1,21 @@
 #ifndef LOGIN_SCREEN_H
 #define LOGIN_SCREEN_H
 
+#include "display_list.h"
 #include <cstdint>
 
-bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height, uint32_t pitch);
+// Pixel counts of the last display list the login screen replayed, kept
+// so overdraw can be read from a debugger or shown on screen
+struct LoginFrameStats {
+    DisplayList::FrameStats pixels;
+    int overdrawPercent;
+    int commands;
+    int culled;
+};
+
+const LoginFrameStats& loginFrameStats();
+
+bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height, uint32_t pitch,
+                    bool backBuffer);
 
 #endif
@@ -1,17 +1,39 @@
 #include "renderer.h"
 #include "input_manager.h"
 #include "font_renderer.h"
+#include "memory.h"
+#include "pixel_kernels.h"
 
 extern "C" {
     void delay_ms(int ms);
     uint64_t get_ticks();
 }
 
-extern bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height, uint32_t pitch);
+extern bool runLoginScreen(uint32_t* framebuffer, uint32_t width, uint32_t height,
+                           uint32_t pitch, bool backBuffer);
+
+// Heap used when the loader provides none. It lives in the image, so it
+// only holds the caches; there is no back buffer and the renderer draws
+// straight to the framebuffer.
+static const size_t FALLBACK_HEAP_SIZE = 2 * 1024 * 1024;
+alignas(64) static uint8_t g_fallback_heap[FALLBACK_HEAP_SIZE];
 
 extern "C" void userspace_main(uint32_t* framebuffer, uint32_t width, 
-                               uint32_t height, uint32_t pitch) {
-    bool success = runLoginScreen(framebuffer, width, height, pitch);
+                               uint32_t height, uint32_t pitch,
+                               uint32_t pixelFormat, uint32_t redMask,
+                               uint32_t greenMask, uint32_t blueMask,
+                               void* heap, uint64_t heapSize) {
+    // The loader sizes the heap for this mode's back buffer
+    bool loaderHeap = heap && heapSize;
+    if (loaderHeap) {
+        LinearAllocator::init(heap, heapSize);
+    } else {
+        LinearAllocator::init(g_fallback_heap, FALLBACK_HEAP_SIZE);
+    }
+    PixelKernels::init();
+    Renderer::setDisplayFormat(pixelFormat, redMask, greenMask, blueMask);
+    
+    bool success = runLoginScreen(framebuffer, width, height, pitch, loaderHeap);
     
     if (!success) {
         return;
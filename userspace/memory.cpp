@@ -14,6 +14,9 @@ void LinearAllocator::init(void* base, size_t size) {
 
 void* LinearAllocator::allocate(size_t size) {
     if (!s_base) return nullptr;
+    
+    // Keep every block 16-byte aligned for the SIMD pixel kernels
+    size = (size + 15) & ~(size_t)15;
     if (s_allocated + size > s_total_size) return nullptr;
     
     void* ptr = s_current;
@@ -28,12 +31,41 @@ void LinearAllocator::deallocate(void* ptr) {
     (void)ptr;
 }
 
+// C runtime memory primitives. GCC emits calls to these for block copies
+// and fills even with -ffreestanding, so they must exist. rep movs/stos are
+// fast on every CPU we target and cannot be turned back into a libcall.
+extern "C" void* memcpy(void* dst, const void* src, size_t n) {
+    void* ret = dst;
+    __asm__ volatile ("rep movsb" : "+D"(dst), "+S"(src), "+c"(n) : : "memory");
+    return ret;
+}
+
+extern "C" void* memmove(void* dst, const void* src, size_t n) {
+    uint8_t* d = (uint8_t*)dst;
+    const uint8_t* s = (const uint8_t*)src;
+    if (d <= s || d >= s + n) {
+        return memcpy(dst, src, n);
+    }
+    // Overlapping with dst above src: copy backwards
+    d += n - 1;
+    s += n - 1;
+    __asm__ volatile ("std\n\trep movsb\n\tcld"
+                      : "+D"(d), "+S"(s), "+c"(n) : : "memory");
+    return dst;
+}
+
+extern "C" void* memset(void* dst, int value, size_t n) {
+    void* ret = dst;
+    __asm__ volatile ("rep stosb" : "+D"(dst), "+c"(n) : "a"(value) : "memory");
+    return ret;
+}
+
 // Global operator new/delete for freestanding C++
-void* operator new(size_t size) {
+void* operator new(size_t size) noexcept {
     return LinearAllocator::allocate(size);
 }
 
-void* operator new[](size_t size) {
+void* operator new[](size_t size) noexcept {
     return LinearAllocator::allocate(size);
 }
 
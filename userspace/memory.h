@@ -18,4 +18,10 @@ private:
     static size_t s_allocated;
 };
 
+// Allocation failure returns nullptr instead of throwing. Declared
+// noexcept so the compiler keeps the null checks after each new; every
+// file that allocates includes this header.
+void* operator new(size_t size) noexcept;
+void* operator new[](size_t size) noexcept;
+
 #endif
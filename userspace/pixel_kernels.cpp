@@ -0,0 +1,370 @@
+#include "pixel_kernels.h"
+#include "pixel_ops.h"
+#include <immintrin.h>
+
+extern "C" {
+    int sse_enabled();
+    int avx_enabled();
+}
+
+// ============================================================
+// SCALAR - always available, also handles SIMD heads and tails
+// ============================================================
+
+static void fillScalar(uint32_t* dst, int count, uint32_t color) {
+    fillPixels(dst, count, color);
+}
+
+static void blendScalar(uint32_t* dst, int count, uint32_t color, uint32_t alpha) {
+    blendPixels(dst, count, premultiply(color, alpha));
+}
+
+static void mixScalar(uint32_t* dst, const uint32_t* src, int count, uint32_t alpha) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = blendPremul(premultiply(src[i], alpha), dst[i]);
+    }
+}
+
+static void addScalar(uint32_t* dst, int count, uint32_t color) {
+    addPixels(dst, count, color);
+}
+
+static inline uint32_t rampPixel(int32_t r, int32_t g, int32_t b) {
+    return (((uint32_t)(r >> 16) & 0xFF) << 16) |
+           (((uint32_t)(g >> 16) & 0xFF) << 8) |
+           ((uint32_t)(b >> 16) & 0xFF);
+}
+
+static void gradientScalar(uint32_t* dst, int count, const GradientRamp& ramp) {
+    int32_t r = ramp.r, g = ramp.g, b = ramp.b;
+    for (int i = 0; i < count; i++) {
+        dst[i] = rampPixel(r, g, b);
+        r += ramp.dr;
+        g += ramp.dg;
+        b += ramp.db;
+    }
+}
+
+static void copyScalar(uint32_t* dst, const uint32_t* src, int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = src[i];
+    }
+}
+
+// ============================================================
+// SSE2 - 4 pixels per step
+// ============================================================
+
+// Exact div255 on 16-bit lanes holding at most 255 * 255
+__attribute__((target("sse2")))
+static inline __m128i div255Epu16(__m128i x) {
+    __m128i one = _mm_set1_epi16(1);
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, one), _mm_srli_epi16(x, 8)), 8);
+}
+
+__attribute__((target("sse2")))
+static void fillSse2(uint32_t* dst, int count, uint32_t color) {
+    __m128i c = _mm_set1_epi32((int)color);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_si128((__m128i*)(dst + i), c);
+        _mm_storeu_si128((__m128i*)(dst + i + 4), c);
+    }
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i*)(dst + i), c);
+    }
+    fillScalar(dst + i, count - i, color);
+}
+
+__attribute__((target("sse2")))
+static void blendSse2(uint32_t* dst, int count, uint32_t color, uint32_t alpha) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i mask = _mm_set1_epi32(0x00FFFFFF);
+    __m128i inv = _mm_set1_epi16((short)(255 - alpha));
+
+    // Two pixels of 16-bit channels, premultiplied by alpha
+    __m128i src = _mm_unpacklo_epi8(_mm_set1_epi32((int)(color & 0xFFFFFF)), zero);
+    src = _mm_mullo_epi16(src, _mm_set1_epi16((short)alpha));
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv), src);
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv), src);
+        __m128i out = _mm_packus_epi16(div255Epu16(lo), div255Epu16(hi));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_and_si128(out, mask));
+    }
+    blendScalar(dst + i, count - i, color, alpha);
+}
+
+__attribute__((target("sse2")))
+static void mixSse2(uint32_t* dst, const uint32_t* src, int count, uint32_t alpha) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i mask = _mm_set1_epi32(0x00FFFFFF);
+    __m128i a = _mm_set1_epi16((short)alpha);
+    __m128i inv = _mm_set1_epi16((short)(255 - alpha));
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), a),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), a),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv));
+        __m128i out = _mm_packus_epi16(div255Epu16(lo), div255Epu16(hi));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_and_si128(out, mask));
+    }
+    mixScalar(dst + i, src + i, count - i, alpha);
+}
+
+__attribute__((target("sse2")))
+static void addSse2(uint32_t* dst, int count, uint32_t color) {
+    __m128i c = _mm_set1_epi32((int)color);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_adds_epu8(d, c));
+    }
+    addScalar(dst + i, count - i, color);
+}
+
+__attribute__((target("sse2")))
+static inline __m128i rampPixelsSse2(__m128i r, __m128i g, __m128i b, __m128i byteMask) {
+    r = _mm_slli_epi32(_mm_and_si128(_mm_srai_epi32(r, 16), byteMask), 16);
+    g = _mm_slli_epi32(_mm_and_si128(_mm_srai_epi32(g, 16), byteMask), 8);
+    b = _mm_and_si128(_mm_srai_epi32(b, 16), byteMask);
+    return _mm_or_si128(_mm_or_si128(r, g), b);
+}
+
+__attribute__((target("sse2")))
+static void gradientSse2(uint32_t* dst, int count, const GradientRamp& ramp) {
+    __m128i byteMask = _mm_set1_epi32(0xFF);
+    __m128i r = _mm_setr_epi32(ramp.r, ramp.r + ramp.dr, ramp.r + 2 * ramp.dr, ramp.r + 3 * ramp.dr);
+    __m128i g = _mm_setr_epi32(ramp.g, ramp.g + ramp.dg, ramp.g + 2 * ramp.dg, ramp.g + 3 * ramp.dg);
+    __m128i b = _mm_setr_epi32(ramp.b, ramp.b + ramp.db, ramp.b + 2 * ramp.db, ramp.b + 3 * ramp.db);
+    __m128i dr = _mm_set1_epi32(4 * ramp.dr);
+    __m128i dg = _mm_set1_epi32(4 * ramp.dg);
+    __m128i db = _mm_set1_epi32(4 * ramp.db);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i*)(dst + i), rampPixelsSse2(r, g, b, byteMask));
+        r = _mm_add_epi32(r, dr);
+        g = _mm_add_epi32(g, dg);
+        b = _mm_add_epi32(b, db);
+    }
+
+    GradientRamp tail = ramp;
+    tail.r += i * ramp.dr;
+    tail.g += i * ramp.dg;
+    tail.b += i * ramp.db;
+    gradientScalar(dst + i, count - i, tail);
+}
+
+__attribute__((target("sse2")))
+static void copySse2(uint32_t* dst, const uint32_t* src, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + i + 4));
+        _mm_storeu_si128((__m128i*)(dst + i), a);
+        _mm_storeu_si128((__m128i*)(dst + i + 4), b);
+    }
+    copyScalar(dst + i, src + i, count - i);
+}
+
+__attribute__((target("sse2")))
+static void streamSse2(uint32_t* dst, const uint32_t* src, int count) {
+    // Align the destination so the stores can bypass the cache
+    int i = 0;
+    while (i < count && ((uintptr_t)(dst + i) & 15) != 0) {
+        dst[i] = src[i];
+        i++;
+    }
+    for (; i + 4 <= count; i += 4) {
+        _mm_stream_si128((__m128i*)(dst + i), _mm_loadu_si128((const __m128i*)(src + i)));
+    }
+    copyScalar(dst + i, src + i, count - i);
+    _mm_sfence();
+}
+
+// ============================================================
+// AVX2 - 8 pixels per step
+// ============================================================
+
+__attribute__((target("avx2")))
+static inline __m256i div255Epu16Avx2(__m256i x) {
+    __m256i one = _mm256_set1_epi16(1);
+    return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, one), _mm256_srli_epi16(x, 8)), 8);
+}
+
+__attribute__((target("avx2")))
+static void fillAvx2(uint32_t* dst, int count, uint32_t color) {
+    __m256i c = _mm256_set1_epi32((int)color);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm256_storeu_si256((__m256i*)(dst + i), c);
+        _mm256_storeu_si256((__m256i*)(dst + i + 8), c);
+    }
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256((__m256i*)(dst + i), c);
+    }
+    fillSse2(dst + i, count - i, color);
+}
+
+__attribute__((target("avx2")))
+static void blendAvx2(uint32_t* dst, int count, uint32_t color, uint32_t alpha) {
+    __m256i zero = _mm256_setzero_si256();
+    __m256i mask = _mm256_set1_epi32(0x00FFFFFF);
+    __m256i inv = _mm256_set1_epi16((short)(255 - alpha));
+
+    // Unpacks work per 128-bit lane, so the premultiplied source is the
+    // same two pixels repeated in both lanes
+    __m256i src = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)(color & 0xFFFFFF)), zero);
+    src = _mm256_mullo_epi16(src, _mm256_set1_epi16((short)alpha));
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), inv), src);
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), inv), src);
+        __m256i out = _mm256_packus_epi16(div255Epu16Avx2(lo), div255Epu16Avx2(hi));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_and_si256(out, mask));
+    }
+    blendSse2(dst + i, count - i, color, alpha);
+}
+
+__attribute__((target("avx2")))
+static void mixAvx2(uint32_t* dst, const uint32_t* src, int count, uint32_t alpha) {
+    __m256i zero = _mm256_setzero_si256();
+    __m256i mask = _mm256_set1_epi32(0x00FFFFFF);
+    __m256i a = _mm256_set1_epi16((short)alpha);
+    __m256i inv = _mm256_set1_epi16((short)(255 - alpha));
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(s, zero), a),
+                                      _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), inv));
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(s, zero), a),
+                                      _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), inv));
+        __m256i out = _mm256_packus_epi16(div255Epu16Avx2(lo), div255Epu16Avx2(hi));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_and_si256(out, mask));
+    }
+    mixSse2(dst + i, src + i, count - i, alpha);
+}
+
+__attribute__((target("avx2")))
+static void addAvx2(uint32_t* dst, int count, uint32_t color) {
+    __m256i c = _mm256_set1_epi32((int)color);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_adds_epu8(d, c));
+    }
+    addSse2(dst + i, count - i, color);
+}
+
+__attribute__((target("avx2")))
+static void gradientAvx2(uint32_t* dst, int count, const GradientRamp& ramp) {
+    __m256i byteMask = _mm256_set1_epi32(0xFF);
+    __m256i steps = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i r = _mm256_add_epi32(_mm256_set1_epi32(ramp.r), _mm256_mullo_epi32(steps, _mm256_set1_epi32(ramp.dr)));
+    __m256i g = _mm256_add_epi32(_mm256_set1_epi32(ramp.g), _mm256_mullo_epi32(steps, _mm256_set1_epi32(ramp.dg)));
+    __m256i b = _mm256_add_epi32(_mm256_set1_epi32(ramp.b), _mm256_mullo_epi32(steps, _mm256_set1_epi32(ramp.db)));
+    __m256i dr = _mm256_set1_epi32(8 * ramp.dr);
+    __m256i dg = _mm256_set1_epi32(8 * ramp.dg);
+    __m256i db = _mm256_set1_epi32(8 * ramp.db);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i pr = _mm256_slli_epi32(_mm256_and_si256(_mm256_srai_epi32(r, 16), byteMask), 16);
+        __m256i pg = _mm256_slli_epi32(_mm256_and_si256(_mm256_srai_epi32(g, 16), byteMask), 8);
+        __m256i pb = _mm256_and_si256(_mm256_srai_epi32(b, 16), byteMask);
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_or_si256(_mm256_or_si256(pr, pg), pb));
+        r = _mm256_add_epi32(r, dr);
+        g = _mm256_add_epi32(g, dg);
+        b = _mm256_add_epi32(b, db);
+    }
+
+    GradientRamp tail = ramp;
+    tail.r += i * ramp.dr;
+    tail.g += i * ramp.dg;
+    tail.b += i * ramp.db;
+    gradientScalar(dst + i, count - i, tail);
+}
+
+__attribute__((target("avx2")))
+static void copyAvx2(uint32_t* dst, const uint32_t* src, int count) {
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(src + i + 8));
+        _mm256_storeu_si256((__m256i*)(dst + i), a);
+        _mm256_storeu_si256((__m256i*)(dst + i + 8), b);
+    }
+    copySse2(dst + i, src + i, count - i);
+}
+
+// ============================================================
+// DISPATCH
+// ============================================================
+
+PixelKernels::Level PixelKernels::s_level = PixelKernels::LEVEL_SCALAR;
+PixelKernels::FillFn PixelKernels::s_fill = fillScalar;
+PixelKernels::BlendFn PixelKernels::s_blend = blendScalar;
+PixelKernels::FillFn PixelKernels::s_add = addScalar;
+PixelKernels::MixFn PixelKernels::s_mix = mixScalar;
+PixelKernels::GradientFn PixelKernels::s_gradient = gradientScalar;
+PixelKernels::CopyFn PixelKernels::s_copy = copyScalar;
+PixelKernels::CopyFn PixelKernels::s_stream = copyScalar;
+
+static inline void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t* a,
+                         uint32_t* b, uint32_t* c, uint32_t* d) {
+    __asm__ volatile ("cpuid" : "=a"(*a), "=b"(*b), "=c"(*c), "=d"(*d)
+                      : "a"(leaf), "c"(subleaf));
+}
+
+void PixelKernels::init() {
+    // The kernel has to have enabled SSE state, or any XMM use is #UD
+    if (!sse_enabled()) return;
+
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(0, 0, &eax, &ebx, &ecx, &edx);
+    uint32_t maxLeaf = eax;
+
+    cpuid(1, 0, &eax, &ebx, &ecx, &edx);
+    if (!(edx & (1u << 26))) return;  // SSE2
+
+    s_level = LEVEL_SSE2;
+    s_fill = fillSse2;
+    s_blend = blendSse2;
+    s_add = addSse2;
+    s_mix = mixSse2;
+    s_gradient = gradientSse2;
+    s_copy = copySse2;
+    s_stream = streamSse2;
+
+    // AVX2 needs CPU support plus YMM state enabled in XCR0
+    if (!avx_enabled() || maxLeaf < 7) return;
+    if (!(ecx & (1u << 27)) || !(ecx & (1u << 28))) return;  // OSXSAVE, AVX
+
+    uint32_t xcr0Lo, xcr0Hi;
+    __asm__ volatile ("xgetbv" : "=a"(xcr0Lo), "=d"(xcr0Hi) : "c"(0));
+    if ((xcr0Lo & 0x6) != 0x6) return;  // SSE and AVX state
+
+    cpuid(7, 0, &eax, &ebx, &ecx, &edx);
+    if (!(ebx & (1u << 5))) return;  // AVX2
+
+    s_level = LEVEL_AVX2;
+    s_fill = fillAvx2;
+    s_blend = blendAvx2;
+    s_add = addAvx2;
+    s_mix = mixAvx2;
+    s_gradient = gradientAvx2;
+    s_copy = copyAvx2;
+    // Streaming stores are bus bound; 16-byte ones are as fast and only
+    // need 16-byte alignment
+}
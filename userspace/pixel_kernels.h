@@ -0,0 +1,79 @@
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include <stdint.h>
+
+// Linear color ramp in 16.16 fixed point: channel c of pixel i is
+// (c + i * dc) >> 16
+struct GradientRamp {
+    int32_t r, g, b;
+    int32_t dr, dg, db;
+};
+
+// Span kernels for the renderer's hot loops. init() picks SSE2 or AVX2
+// versions once via CPUID; until then, or when the kernel did not enable
+// SSE state, the scalar versions run.
+class PixelKernels {
+public:
+    enum Level {
+        LEVEL_SCALAR,
+        LEVEL_SSE2,
+        LEVEL_AVX2
+    };
+
+    static void init();
+    static Level level() { return s_level; }
+
+    // dst[i] = color
+    static void fill(uint32_t* dst, int count, uint32_t color) {
+        s_fill(dst, count, color);
+    }
+
+    // dst[i] = (color * alpha + dst[i] * (255 - alpha)) / 255, exact
+    static void blend(uint32_t* dst, int count, uint32_t color, uint32_t alpha) {
+        s_blend(dst, count, color, alpha);
+    }
+
+    // dst[i] = (src[i] * alpha + dst[i] * (255 - alpha)) / 255, exact
+    static void mix(uint32_t* dst, const uint32_t* src, int count, uint32_t alpha) {
+        s_mix(dst, src, count, alpha);
+    }
+
+    // dst[i] = min(dst[i] + color, 255) per channel
+    static void add(uint32_t* dst, int count, uint32_t color) {
+        s_add(dst, count, color);
+    }
+
+    // dst[i] = ramp evaluated at i
+    static void gradient(uint32_t* dst, int count, const GradientRamp& ramp) {
+        s_gradient(dst, count, ramp);
+    }
+
+    // Cached copy for RAM to RAM
+    static void copy(uint32_t* dst, const uint32_t* src, int count) {
+        s_copy(dst, src, count);
+    }
+
+    // Non-temporal copy for write-only destinations like the framebuffer
+    static void stream(uint32_t* dst, const uint32_t* src, int count) {
+        s_stream(dst, src, count);
+    }
+
+private:
+    typedef void (*FillFn)(uint32_t*, int, uint32_t);
+    typedef void (*BlendFn)(uint32_t*, int, uint32_t, uint32_t);
+    typedef void (*GradientFn)(uint32_t*, int, const GradientRamp&);
+    typedef void (*CopyFn)(uint32_t*, const uint32_t*, int);
+    typedef void (*MixFn)(uint32_t*, const uint32_t*, int, uint32_t);
+
+    static Level s_level;
+    static FillFn s_fill;
+    static BlendFn s_blend;
+    static FillFn s_add;
+    static MixFn s_mix;
+    static GradientFn s_gradient;
+    static CopyFn s_copy;
+    static CopyFn s_stream;
+};
+
+#endif // PIXEL_KERNELS_H
@@ -0,0 +1,91 @@
+#ifndef PIXEL_OPS_H
+#define PIXEL_OPS_H
+
+#include <stdint.h>
+
+// Division-free pixel math shared by Renderer and GfxEffects.
+// Pixels are 0x00RRGGBB; blending matches (src * a + dst * (255 - a)) / 255
+// exactly, just without the three divisions.
+
+// Exact floor(x / 255) for x in [0, 255 * 255]
+static inline uint32_t div255(uint32_t x) {
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+// Source color with alpha already multiplied in. Red and blue share one
+// 32-bit word (one 16-bit lane each), so a blend costs two multiplies.
+struct PremulColor {
+    uint32_t rb;    // (R * a) << 16 | (B * a)
+    uint32_t g;     // G * a
+    uint32_t inv;   // 255 - a
+};
+
+static inline PremulColor premultiply(uint32_t rgb, uint32_t alpha) {
+    PremulColor p;
+    p.rb = (rgb & 0xFF00FF) * alpha;
+    p.g = ((rgb >> 8) & 0xFF) * alpha;
+    p.inv = 255 - alpha;
+    return p;
+}
+
+static inline uint32_t blendPremul(const PremulColor& src, uint32_t dst) {
+    uint32_t rb = src.rb + (dst & 0xFF00FF) * src.inv;
+    uint32_t g = src.g + ((dst >> 8) & 0xFF) * src.inv;
+
+    // div255 on both 16-bit lanes at once; lanes never exceed 65025
+    rb = ((rb + 0x10001 + ((rb >> 8) & 0xFF00FF)) >> 8) & 0xFF00FF;
+    return rb | (div255(g) << 8);
+}
+
+// Per-channel saturating add, four byte lanes at once
+static inline uint32_t addSaturate(uint32_t dst, uint32_t src) {
+    uint32_t low = (dst & 0x7F7F7F7F) + (src & 0x7F7F7F7F);
+    uint32_t top = (dst ^ src) & 0x80808080;
+    uint32_t carry = ((dst & src) | (low & top)) & 0x80808080;
+    return (low ^ top) | ((carry >> 7) * 0xFF);
+}
+
+// Color with every channel scaled by alpha / 255, exact
+static inline uint32_t scalePixel(uint32_t rgb, uint32_t alpha) {
+    return blendPremul(premultiply(rgb, alpha), 0);
+}
+
+// Scale an alpha by an 8-bit coverage value
+static inline uint32_t mulAlpha(uint32_t alpha, uint32_t coverage) {
+    return div255(alpha * coverage);
+}
+
+// Pixel pair view of a row; may_alias keeps it legal next to uint32_t access
+typedef uint64_t __attribute__((may_alias)) PixelPair;
+
+// Opaque fill, two pixels per store once the pointer is 8-byte aligned
+static inline void fillPixels(uint32_t* dst, int count, uint32_t color) {
+    if (count <= 0) return;
+    if (((uintptr_t)dst & 7) != 0) {
+        *dst++ = color;
+        count--;
+    }
+
+    PixelPair pair = ((PixelPair)color << 32) | color;
+    PixelPair* wide = (PixelPair*)dst;
+    for (int i = 0; i < count / 2; i++) {
+        wide[i] = pair;
+    }
+    if (count & 1) {
+        dst[count - 1] = color;
+    }
+}
+
+static inline void blendPixels(uint32_t* dst, int count, const PremulColor& src) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = blendPremul(src, dst[i]);
+    }
+}
+
+static inline void addPixels(uint32_t* dst, int count, uint32_t color) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = addSaturate(dst[i], color);
+    }
+}
+
+#endif // PIXEL_OPS_H
@@ -1,116 +1,561 @@
 #include "renderer.h"
+#include "pixel_ops.h"
+#include "pixel_kernels.h"
+#include "memory.h"
 
-extern "C" {
-    // Math helpers
+Renderer::DisplayFormat Renderer::s_displayFormat = {
+    false, false, {16, 8}, {8, 8}, {0, 8}
+};
 
-}
+Renderer::Renderer(uint32_t* fb, uint32_t width, uint32_t height, uint32_t pitch,
+                   const DisplayFormat& format)
+    : m_framebuffer(fb), m_backBuffer(nullptr), m_target(fb),
+      m_width(width), m_height(height), m_pitch(pitch),
+      m_targetPitch(pitch), m_globalAlpha(255), m_blendMode(BLEND_ALPHA),
+      m_format(format),
+      m_damageCount(0), m_lastDamage(0),
+      m_clip{0, 0, (int)width, (int)height}, m_clipDepth(0), m_clipOverflow(0) {}
 
 Renderer::Renderer(uint32_t* fb, uint32_t width, uint32_t height, uint32_t pitch)
-    : m_framebuffer(fb), m_width(width), m_height(height), 
-      m_pitch(pitch), m_globalAlpha(255) {}
-
-void Renderer::clear(Color color) {
-    uint32_t c = color.toRGBA();
-    for (uint32_t i = 0; i < m_width * m_height; i++) {
-        m_framebuffer[i] = c;
-    }
+    : Renderer(fb, width, height, pitch, s_displayFormat) {
+    // Repacked layouts cannot be drawn into directly
+    if (m_format.repack) enableBackBuffer();
 }
 
-uint32_t Renderer::blend(uint32_t fg, uint32_t bg, uint8_t alpha) {
-    if (alpha >= 255) return fg;
-    if (alpha == 0) return bg;
-    
-    uint32_t r1 = (fg >> 16) & 0xFF;
-    uint32_t g1 = (fg >> 8) & 0xFF;
-    uint32_t b1 = fg & 0xFF;
+// Surfaces always hold drawing-layout pixels; only present() repacks
+Renderer::Renderer(Surface& surface)
+    : Renderer(surface.pixels(), surface.width(), surface.height(), surface.pitch(),
+               DisplayFormat{s_displayFormat.swapRedBlue, false,
+                             s_displayFormat.red, s_displayFormat.green, s_displayFormat.blue}) {}
+
+void Renderer::setDisplayFormat(uint32_t format, uint32_t redMask,
+                                uint32_t greenMask, uint32_t blueMask) {
+    auto channelLayout = [](uint32_t mask) {
+        uint8_t shift = 0, bits = 0;
+        while (shift < 32 && !(mask & (1u << shift))) shift++;
+        while (shift + bits < 32 && (mask & (1u << (shift + bits)))) bits++;
+        if (bits > 8) {
+            // Wider channels keep their top 8 bits
+            shift += bits - 8;
+            bits = 8;
+        }
+        return ChannelLayout{shift, bits};
+    };
     
-    uint32_t r2 = (bg >> 16) & 0xFF;
-    uint32_t g2 = (bg >> 8) & 0xFF;
-    uint32_t b2 = bg & 0xFF;
+    DisplayFormat f = {false, false, {16, 8}, {8, 8}, {0, 8}};
     
-    uint32_t r = (r1 * alpha + r2 * (255 - alpha)) / 255;
-    uint32_t g = (g1 * alpha + g2 * (255 - alpha)) / 255;
-    uint32_t b = (b1 * alpha + b2 * (255 - alpha)) / 255;
+    if (format == PIXEL_RGB8) {
+        f.swapRedBlue = true;
+    } else if (format == PIXEL_BITMASK) {
+        if (redMask == 0xFF && greenMask == 0xFF00 && blueMask == 0xFF0000) {
+            f.swapRedBlue = true;
+        } else if (redMask != 0xFF0000 || greenMask != 0xFF00 || blueMask != 0xFF) {
+            f.repack = true;
+            f.red = channelLayout(redMask);
+            f.green = channelLayout(greenMask);
+            f.blue = channelLayout(blueMask);
+        }
+    }
     
+    s_displayFormat = f;
+}
+
+// 0x00RRGGBB to a bitmask framebuffer pixel
+uint32_t Renderer::repackPixel(uint32_t rgb) const {
+    uint32_t r = (rgb >> 16) & 0xFF, g = (rgb >> 8) & 0xFF, b = rgb & 0xFF;
+    return ((r >> (8 - m_format.red.bits)) << m_format.red.shift) |
+           ((g >> (8 - m_format.green.bits)) << m_format.green.shift) |
+           ((b >> (8 - m_format.blue.bits)) << m_format.blue.shift);
+}
+
+uint32_t Renderer::unpackPixel(uint32_t pixel) const {
+    uint32_t r = ((pixel >> m_format.red.shift) << (8 - m_format.red.bits)) & 0xFF;
+    uint32_t g = ((pixel >> m_format.green.shift) << (8 - m_format.green.bits)) & 0xFF;
+    uint32_t b = ((pixel >> m_format.blue.shift) << (8 - m_format.blue.bits)) & 0xFF;
     return (r << 16) | (g << 8) | b;
 }
 
-void Renderer::drawPixel(int x, int y, Color color) {
-    if (x < 0 || x >= (int)m_width || y < 0 || y >= (int)m_height) return;
+// ============================================================
+// SPAN PIPELINES
+// ============================================================
+//
+// withSpan() picks one of these per primitive from the blend mode and the
+// color's alpha, and the primitive's row walker is instantiated for it, so
+// rows go straight to a kernel without testing the mode per pixel. The
+// pixel is already packed in the target layout; blending treats all three
+// channels alike, so the same math serves RGB and BGR.
+//
+//   span(dst, count)      whole span at full strength
+//   span.apply(dst)       one pixel at full strength
+//   span.cover(dst, c)    one pixel at coverage c (0 leaves dst unchanged)
+
+namespace {
+
+struct OpaqueSpan {
+    uint32_t pixel;
+    
+    void operator()(uint32_t* dst, int count) const { PixelKernels::fill(dst, count, pixel); }
+    uint32_t apply(uint32_t) const { return pixel; }
+    uint32_t cover(uint32_t dst, uint32_t coverage) const {
+        return blendPremul(premultiply(pixel, coverage), dst);
+    }
+};
+
+struct AlphaSpan {
+    uint32_t pixel;
+    uint32_t alpha;
+    PremulColor premul;
+    
+    void operator()(uint32_t* dst, int count) const { PixelKernels::blend(dst, count, pixel, alpha); }
+    uint32_t apply(uint32_t dst) const { return blendPremul(premul, dst); }
+    uint32_t cover(uint32_t dst, uint32_t coverage) const {
+        return blendPremul(premultiply(pixel, mulAlpha(alpha, coverage)), dst);
+    }
+};
+
+struct AddSpan {
+    uint32_t pixel;
+    uint32_t alpha;
+    uint32_t scaled;      // pixel * alpha / 255
+    
+    void operator()(uint32_t* dst, int count) const { PixelKernels::add(dst, count, scaled); }
+    uint32_t apply(uint32_t dst) const { return addSaturate(dst, scaled); }
+    uint32_t cover(uint32_t dst, uint32_t coverage) const {
+        return addSaturate(dst, scalePixel(pixel, mulAlpha(alpha, coverage)));
+    }
+};
+
+} // namespace
+
+template <class Draw>
+void Renderer::withSpan(Color color, const Draw& draw) {
+    if (color.a == 0) return;
     
-    uint32_t offset = y * m_pitch + x;
-    if (color.a == 255) {
-        m_framebuffer[offset] = color.toRGBA();
+    uint32_t pixel = pack(color);
+    if (m_blendMode == BLEND_ADD) {
+        draw(AddSpan{pixel, color.a, scalePixel(pixel, color.a)});
+    } else if (color.a == 255) {
+        draw(OpaqueSpan{pixel});
     } else {
-        m_framebuffer[offset] = blend(color.toRGBA(), m_framebuffer[offset], color.a);
+        draw(AlphaSpan{pixel, color.a, premultiply(pixel, color.a)});
     }
 }
 
-int Renderer::distanceSquared(int x1, int y1, int x2, int y2) {
-    int dx = x2 - x1;
-    int dy = y2 - y1;
-    return dx * dx + dy * dy;
+// Fill [x0, x1) of row y, clipped once so the inner loop is branch-free
+template <class Span>
+void Renderer::fillSpan(int y, int x0, int x1, const Span& span) {
+    if (y < m_clip.y || y >= m_clip.y + m_clip.h) return;
+    if (x0 < m_clip.x) x0 = m_clip.x;
+    if (x1 > m_clip.x + m_clip.w) x1 = m_clip.x + m_clip.w;
+    if (x1 <= x0) return;
+    
+    span(m_target + y * m_targetPitch + x0, x1 - x0);
 }
 
-void Renderer::drawCircle(int cx, int cy, int radius, Color color) {
-    for (int y = cy - radius - 1; y <= cy + radius + 1; y++) {
-        for (int x = cx - radius - 1; x <= cx + radius + 1; x++) {
-            int distSq = distanceSquared(cx, cy, x, y);
-            int radiusSq = radius * radius;
-            
-            if (distSq >= radiusSq && distSq <= (radius + 1) * (radius + 1)) {
-                drawPixel(x, y, color);
+static inline int rectArea(const Renderer::Rect& r) {
+    return r.w * r.h;
+}
+
+static inline bool rectContains(const Renderer::Rect& outer, const Renderer::Rect& inner) {
+    return inner.x >= outer.x && inner.y >= outer.y &&
+           inner.x + inner.w <= outer.x + outer.w &&
+           inner.y + inner.h <= outer.y + outer.h;
+}
+
+// True if the rects overlap or share an edge
+static inline bool rectTouches(const Renderer::Rect& a, const Renderer::Rect& b) {
+    return a.x <= b.x + b.w && b.x <= a.x + a.w &&
+           a.y <= b.y + b.h && b.y <= a.y + a.h;
+}
+
+static inline Renderer::Rect rectUnion(const Renderer::Rect& a, const Renderer::Rect& b) {
+    int x0 = a.x < b.x ? a.x : b.x;
+    int y0 = a.y < b.y ? a.y : b.y;
+    int x1 = (a.x + a.w) > (b.x + b.w) ? (a.x + a.w) : (b.x + b.w);
+    int y1 = (a.y + a.h) > (b.y + b.h) ? (a.y + a.h) : (b.y + b.h);
+    return Renderer::Rect{x0, y0, x1 - x0, y1 - y0};
+}
+
+bool Renderer::enableBackBuffer() {
+    if (m_backBuffer) return true;
+    
+    m_backBuffer = new uint32_t[m_width * m_height];
+    if (!m_backBuffer) return false;
+    
+    // Start from what is on screen so partial redraws stay consistent
+    for (uint32_t y = 0; y < m_height; y++) {
+        uint32_t* dst = m_backBuffer + y * m_width;
+        const uint32_t* src = m_framebuffer + y * m_pitch;
+        if (m_format.repack) {
+            for (uint32_t x = 0; x < m_width; x++) dst[x] = unpackPixel(src[x]);
+        } else {
+            PixelKernels::copy(dst, src, m_width);
+        }
+    }
+    
+    m_target = m_backBuffer;
+    m_targetPitch = m_width;
+    return true;
+}
+
+void Renderer::present() {
+    if (m_backBuffer) {
+        // Write-only streaming: rows go out in order, VRAM is never read
+        for (int i = 0; i < m_damageCount; i++) {
+            const Rect& r = m_damage[i];
+            for (int y = r.y; y < r.y + r.h; y++) {
+                uint32_t* dst = m_framebuffer + y * m_pitch + r.x;
+                const uint32_t* src = m_backBuffer + y * m_width + r.x;
+                if (m_format.repack) {
+                    for (int x = 0; x < r.w; x++) dst[x] = repackPixel(src[x]);
+                } else {
+                    PixelKernels::stream(dst, src, r.w);
+                }
             }
         }
     }
+    
+    m_damageCount = 0;
+    m_lastDamage = 0;
 }
 
-void Renderer::drawFilledCircle(int cx, int cy, int radius, Color color) {
-    for (int y = cy - radius; y <= cy + radius; y++) {
-        for (int x = cx - radius; x <= cx + radius; x++) {
-            if (distanceSquared(cx, cy, x, y) <= radius * radius) {
-                drawPixel(x, y, color);
+void Renderer::addDamage(int x, int y, int width, int height) {
+    // Clip to screen
+    if (x < 0) { width += x; x = 0; }
+    if (y < 0) { height += y; y = 0; }
+    if (x + width > (int)m_width) width = m_width - x;
+    if (y + height > (int)m_height) height = m_height - y;
+    if (width <= 0 || height <= 0) return;
+    
+    Rect rect{x, y, width, height};
+    
+    // Fast path: per-pixel callers usually land in the same rect
+    if (m_damageCount > 0 && rectContains(m_damage[m_lastDamage], rect)) return;
+    
+    // Fold in every rect that touches the new one as long as the union
+    // does not cover much more than the two parts did
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < m_damageCount; i++) {
+            const Rect& other = m_damage[i];
+            if (rectContains(other, rect)) {
+                m_lastDamage = i;
+                return;
             }
+            if (!rectTouches(other, rect)) continue;
+            
+            Rect u = rectUnion(other, rect);
+            if (rectArea(u) * 4 > (rectArea(other) + rectArea(rect)) * 5) continue;
+            
+            rect = u;
+            m_damage[i] = m_damage[--m_damageCount];
+            merged = true;
+            break;
         }
     }
+    
+    if (m_damageCount == MAX_DAMAGE_RECTS) {
+        mergeCheapestDamagePair();
+    }
+    m_lastDamage = m_damageCount;
+    m_damage[m_damageCount++] = rect;
 }
 
-void Renderer::drawRectangle(int x, int y, int width, int height, Color color) {
-    // Top and bottom
-    for (int i = 0; i < width; i++) {
-        drawPixel(x + i, y, color);
-        drawPixel(x + i, y + height - 1, color);
+bool Renderer::pushClip(int x, int y, int width, int height) {
+    bool saved = m_clipDepth < MAX_CLIP_DEPTH;
+    if (saved) {
+        m_clipStack[m_clipDepth++] = m_clip;
+    } else {
+        m_clipOverflow++;
+    }
+    m_clip = clipBounds(x, y, width, height);
+    return saved;
+}
+
+void Renderer::popClip() {
+    if (m_clipOverflow > 0) {
+        m_clipOverflow--;
+        return;
+    }
+    if (m_clipDepth > 0) {
+        m_clip = m_clipStack[--m_clipDepth];
     }
+}
+
+Renderer::Rect Renderer::clipBounds(int x, int y, int width, int height) const {
+    int x0 = x > m_clip.x ? x : m_clip.x;
+    int y0 = y > m_clip.y ? y : m_clip.y;
+    int x1 = (x + width) < (m_clip.x + m_clip.w) ? (x + width) : (m_clip.x + m_clip.w);
+    int y1 = (y + height) < (m_clip.y + m_clip.h) ? (y + height) : (m_clip.y + m_clip.h);
+    
+    if (x1 <= x0 || y1 <= y0) return Rect{x0, y0, 0, 0};
+    return Rect{x0, y0, x1 - x0, y1 - y0};
+}
+
+void Renderer::mergeCheapestDamagePair() {
+    int bestA = 0, bestB = 1;
+    int bestCost = 0x7FFFFFFF;
     
-    // Left and right
-    for (int i = 0; i < height; i++) {
-        drawPixel(x, y + i, color);
-        drawPixel(x + width - 1, y + i, color);
+    for (int a = 0; a < m_damageCount; a++) {
+        for (int b = a + 1; b < m_damageCount; b++) {
+            int cost = rectArea(rectUnion(m_damage[a], m_damage[b])) -
+                       rectArea(m_damage[a]) - rectArea(m_damage[b]);
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestA = a;
+                bestB = b;
+            }
+        }
     }
+    
+    m_damage[bestA] = rectUnion(m_damage[bestA], m_damage[bestB]);
+    m_damage[bestB] = m_damage[--m_damageCount];
 }
 
-void Renderer::drawFilledRectangle(int x, int y, int width, int height, Color color) {
-    uint32_t rgba = color.toRGBA();
-    
-    for (int py = y; py < y + height && py < (int)m_height; py++) {
-        if (py < 0) continue;
-        uint32_t* row = m_framebuffer + (py * m_pitch);
-        for (int px = x; px < x + width && px < (int)m_width; px++) {
-            if (px < 0) continue;
-            row[px] = rgba;
+void Renderer::clear(Color color) {
+    Rect area = markDamage(0, 0, m_width, m_height);
+    
+    uint32_t c = pack(color);
+    for (int y = area.y; y < area.y + area.h; y++) {
+        PixelKernels::fill(m_target + y * m_targetPitch + area.x, area.w, c);
+    }
+}
+
+void Renderer::drawPixel(int x, int y, Color color) {
+    if (x < m_clip.x || x >= m_clip.x + m_clip.w ||
+        y < m_clip.y || y >= m_clip.y + m_clip.h) return;
+    
+    addDamage(x, y, 1, 1);
+    blendPixel(x, y, color);
+}
+
+void Renderer::blendPixel(int x, int y, Color color) {
+    uint32_t* px = m_target + y * m_targetPitch + x;
+    withSpan(color, [&](const auto& span) {
+        *px = span.apply(*px);
+    });
+}
+
+void Renderer::fillRow(int x, int y, int width, Color color) {
+    markDamage(x, y, width, 1);
+    withSpan(color, [&](const auto& span) {
+        fillSpan(y, x, x + width, span);
+    });
+}
+
+void Renderer::copyRow(int x, int y, int width, const uint32_t* pixels) {
+    Rect area = markDamage(x, y, width, 1);
+    if (area.w == 0) return;
+    PixelKernels::copy(m_target + y * m_targetPitch + area.x, pixels + (area.x - x), area.w);
+}
+
+void Renderer::blendRow(int x, int y, int width, Color color, const uint8_t* coverage) {
+    Rect area = markDamage(x, y, width, 1);
+    if (area.w == 0) return;
+    
+    uint32_t* row = m_target + y * m_targetPitch + area.x;
+    coverage += area.x - x;
+    
+    withSpan(color, [&](const auto& span) {
+        for (int i = 0; i < area.w; i++) {
+            row[i] = span.cover(row[i], coverage[i]);
+        }
+    });
+}
+
+void Renderer::blit(const Surface& src, int x, int y, uint8_t alpha) {
+    blitRect(src, Rect{0, 0, (int)src.width(), (int)src.height()}, x, y, alpha);
+}
+
+void Renderer::blitRect(const Surface& src, const Rect& srcRect, int x, int y, uint8_t alpha) {
+    // Clip the source rect to the surface, moving the destination along
+    int sx = srcRect.x, sy = srcRect.y, w = srcRect.w, h = srcRect.h;
+    if (sx < 0) { x -= sx; w += sx; sx = 0; }
+    if (sy < 0) { y -= sy; h += sy; sy = 0; }
+    if (sx + w > (int)src.width()) w = src.width() - sx;
+    if (sy + h > (int)src.height()) h = src.height() - sy;
+    if (w <= 0 || h <= 0 || alpha == 0) return;
+    
+    Rect area = markDamage(x, y, w, h);
+    if (area.w == 0) return;
+    
+    const uint32_t* from = src.row(sy + area.y - y) + sx + area.x - x;
+    uint32_t* to = m_target + area.y * m_targetPitch + area.x;
+    for (int py = 0; py < area.h; py++, from += src.pitch(), to += m_targetPitch) {
+        if (alpha == 255) {
+            PixelKernels::copy(to, from, area.w);
+        } else {
+            PixelKernels::mix(to, from, area.w, alpha);
         }
     }
 }
 
+// Clip to the current clip rect and add the result to the damage list
+Renderer::Rect Renderer::markDamage(int x, int y, int width, int height) {
+    Rect area = clipBounds(x, y, width, height);
+    if (area.w > 0) addDamage(area.x, area.y, area.w, area.h);
+    return area;
+}
+
+// Largest half-width w >= start with w*w <= limit. Rows are walked from
+// the top or bottom of a circle towards its center, so limit only grows
+// and each call advances w by the few pixels the extent gained.
+static inline int growExtent(int w, int limit) {
+    while ((w + 1) * (w + 1) <= limit) w++;
+    return w;
+}
+
+// Same as growExtent but may also shrink, for rows that walk through the
+// center of a circle and out again
+static inline int fitExtent(int w, int limit) {
+    while (w >= 0 && w * w > limit) w--;
+    return growExtent(w, limit);
+}
+
+// Ring of pixels with radius^2 <= d^2 <= (radius + 1)^2, emitted as at most
+// two spans per row. Rows are mirrored around cy so each extent is found
+// incrementally once.
+void Renderer::drawCircle(int cx, int cy, int radius, Color color) {
+    if (radius < 0) return;
+    Rect area = markDamage(cx - radius - 1, cy - radius - 1, 2 * radius + 3, 2 * radius + 3);
+    if (area.w == 0) return;
+    
+    withSpan(color, [&](const auto& span) {
+        int innerSq = radius * radius;
+        int outerSq = (radius + 1) * (radius + 1);
+        int outer = -1;   // Max |dx| with dx^2 + dy^2 <= outerSq
+        int inner = -1;   // Max |dx| with dx^2 + dy^2 < innerSq
+        
+        for (int dy = radius + 1; dy >= 0; dy--) {
+            int dySq = dy * dy;
+            outer = growExtent(outer, outerSq - dySq);
+            if (innerSq - dySq > 0) inner = growExtent(inner, innerSq - dySq - 1);
+            if (outer < 0) continue;
+            
+            for (int side = 0; side < (dy ? 2 : 1); side++) {
+                int y = side ? cy - dy : cy + dy;
+                if (inner < 0) {
+                    fillSpan(y, cx - outer, cx + outer + 1, span);
+                } else {
+                    fillSpan(y, cx - outer, cx - inner, span);
+                    fillSpan(y, cx + inner + 1, cx + outer + 1, span);
+                }
+            }
+        }
+    });
+}
+
+void Renderer::drawFilledCircle(int cx, int cy, int radius, Color color) {
+    if (radius < 0) return;
+    Rect area = markDamage(cx - radius, cy - radius, 2 * radius + 1, 2 * radius + 1);
+    if (area.w == 0) return;
+    
+    withSpan(color, [&](const auto& span) {
+        int radiusSq = radius * radius;
+        int extent = 0;
+        
+        for (int dy = radius; dy >= 0; dy--) {
+            extent = growExtent(extent, radiusSq - dy * dy);
+            fillSpan(cy + dy, cx - extent, cx + extent + 1, span);
+            if (dy) fillSpan(cy - dy, cx - extent, cx + extent + 1, span);
+        }
+    });
+}
 
+void Renderer::drawRectangle(int x, int y, int width, int height, Color color) {
+    if (width <= 0 || height <= 0) return;
+    
+    Rect area = clipBounds(x, y, width, height);
+    if (area.w == 0) return;
+    markDamage(x, y, width, 1);
+    markDamage(x, y + height - 1, width, 1);
+    markDamage(x, y, 1, height);
+    markDamage(x + width - 1, y, 1, height);
+    
+    withSpan(color, [&](const auto& span) {
+        // Top and bottom
+        fillSpan(y, x, x + width, span);
+        if (height > 1) fillSpan(y + height - 1, x, x + width, span);
+        
+        // Left and right, without the corners already drawn above
+        for (int py = area.y; py < area.y + area.h; py++) {
+            if (py == y || py == y + height - 1) continue;
+            fillSpan(py, x, x + 1, span);
+            if (width > 1) fillSpan(py, x + width - 1, x + width, span);
+        }
+    });
+}
+
+void Renderer::drawFilledRectangle(int x, int y, int width, int height, Color color) {
+    Rect area = markDamage(x, y, width, height);
+    if (area.w == 0) return;
+    
+    withSpan(color, [&](const auto& span) {
+        uint32_t* row = m_target + area.y * m_targetPitch + area.x;
+        for (int py = 0; py < area.h; py++, row += m_targetPitch) {
+            span(row, area.w);
+        }
+    });
+}
+
+// Body plus four corner discs, emitted as one span per row so translucent
+// colors are blended exactly once where the parts overlap
 void Renderer::drawRoundedRect(int x, int y, int width, int height, int radius, Color color) {
-    // Main body
-    drawFilledRectangle(x + radius, y, width - 2 * radius, height, color);
-    drawFilledRectangle(x, y + radius, width, height - 2 * radius, color);
-    
-    // Four corners
-    drawFilledCircle(x + radius, y + radius, radius, color);
-    drawFilledCircle(x + width - radius, y + radius, radius, color);
-    drawFilledCircle(x + radius, y + height - radius, radius, color);
-    drawFilledCircle(x + width - radius, y + height - radius, radius, color);
+    if (width <= 0 || height <= 0) return;
+    if (radius > width / 2) radius = width / 2;
+    if (radius > height / 2) radius = height / 2;
+    if (radius <= 0) {
+        drawFilledRectangle(x, y, width, height, color);
+        return;
+    }
+    
+    // Corner discs are centered on the rect edge minus radius, so the
+    // right and bottom ones reach one pixel past the body
+    Rect area = markDamage(x, y, width + 1, height + 1);
+    if (area.w == 0) return;
+    
+    withSpan(color, [&](const auto& span) {
+        int radiusSq = radius * radius;
+        int topCenter = y + radius;
+        int bottomCenter = y + height - radius;
+        int topExtent = -1;
+        int bottomExtent = -1;
+        
+        for (int py = y; py < y + height; py++) {
+            int x0 = x + width + 1;
+            int x1 = x;
+            
+            if (width > 2 * radius) {
+                x0 = x + radius;
+                x1 = x + width - radius;
+            }
+            if (py >= topCenter && py < bottomCenter) {
+                x0 = x;
+                x1 = x + width;
+            }
+            
+            int dy = py - topCenter;
+            if (dy >= -radius && dy <= radius) {
+                topExtent = fitExtent(topExtent, radiusSq - dy * dy);
+                if (x + radius - topExtent < x0) x0 = x + radius - topExtent;
+                if (x + width - radius + topExtent + 1 > x1) x1 = x + width - radius + topExtent + 1;
+            }
+            
+            dy = py - bottomCenter;
+            if (dy >= -radius && dy <= radius) {
+                bottomExtent = fitExtent(bottomExtent, radiusSq - dy * dy);
+                if (x + radius - bottomExtent < x0) x0 = x + radius - bottomExtent;
+                if (x + width - radius + bottomExtent + 1 > x1) x1 = x + width - radius + bottomExtent + 1;
+            }
+            
+            fillSpan(py, x0, x1, span);
+        }
+        
+        // Bottom discs touch the row below the body in a single pixel each
+        fillSpan(y + height, x + radius, x + radius + 1, span);
+        if (width > 2 * radius) {
+            fillSpan(y + height, x + width - radius, x + width - radius + 1, span);
+        }
+    });
 }
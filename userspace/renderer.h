@@ -2,6 +2,7 @@
 #define RENDERER_H
 
 #include <stdint.h>
+#include "surface.h"
 
 class Renderer {
 public:
@@ -16,8 +17,90 @@ public:
         }
     };
     
+    struct Rect {
+        int x, y, w, h;
+    };
+    
+    // Framebuffer pixel formats, numbered like EFI_GRAPHICS_PIXEL_FORMAT
+    enum PixelFormat {
+        PIXEL_RGB8 = 0,       // Bytes R, G, B, x: 0x00BBGGRR
+        PIXEL_BGR8 = 1,       // Bytes B, G, R, x: 0x00RRGGBB
+        PIXEL_BITMASK = 2     // Channel positions given by masks
+    };
+    
+    enum BlendMode {
+        BLEND_ALPHA,          // Source over; opaque colors are plain fills
+        BLEND_ADD             // Saturating add of color * alpha
+    };
+    
+    // Damage list is capped; overflow merges the cheapest pair
+    static const int MAX_DAMAGE_RECTS = 16;
+    static const int MAX_CLIP_DEPTH = 8;
+    
     Renderer(uint32_t* fb, uint32_t width, uint32_t height, uint32_t pitch);
     
+    // Draw into an off-screen surface. present() is a no-op; composite
+    // the surface onto a screen renderer with blit().
+    explicit Renderer(Surface& surface);
+    
+    // Framebuffer format as reported by GOP, for renderers created
+    // afterwards (default PIXEL_BGR8). Byte-aligned layouts are drawn in
+    // natively; other bitmask layouts are drawn in the back buffer and
+    // repacked by present().
+    static void setDisplayFormat(uint32_t format, uint32_t redMask,
+                                 uint32_t greenMask, uint32_t blueMask);
+    
+    // Color as a pixel of the render target's layout, for callers that
+    // hand whole rows to copyRow()
+    uint32_t pack(Color color) const {
+        return m_format.swapRedBlue ? (color.b << 16) | (color.g << 8) | color.r
+                                    : color.toRGBA();
+    }
+    bool swapsRedBlue() const { return m_format.swapRedBlue; }
+    
+    // Allocate a system-RAM back buffer. All drawing and blending then
+    // happens in RAM and present() streams the finished frame to the
+    // framebuffer. Returns false (and keeps drawing directly) if the
+    // allocation fails.
+    bool enableBackBuffer();
+    bool hasBackBuffer() const { return m_backBuffer != nullptr; }
+    
+    // Copy the damaged parts of the back buffer to the framebuffer and
+    // reset the damage list (no copy without back buffer)
+    void present();
+    
+    // Damage tracking. Every primitive marks what it touches; callers can
+    // also mark regions they changed behind the renderer's back.
+    void addDamage(int x, int y, int width, int height);
+    void damageAll() { addDamage(0, 0, m_width, m_height); }
+    int damageCount() const { return m_damageCount; }
+    const Rect& damageRect(int index) const { return m_damage[index]; }
+    
+    // Clip stack. Each push intersects with the current clip; all
+    // primitives are confined to it and clip once per row or primitive.
+    // Past MAX_CLIP_DEPTH the clip is still narrowed but cannot be saved,
+    // so popping that push keeps it narrowed until a saved level is popped;
+    // pushClip() then returns false.
+    bool pushClip(int x, int y, int width, int height);
+    void popClip();
+    const Rect& clipRect() const { return m_clip; }
+    int clipDepth() const { return m_clipDepth + m_clipOverflow; }
+    
+    // Intersect a rect with the current clip (empty rect has w or h == 0)
+    Rect clipBounds(int x, int y, int width, int height) const;
+    
+    // Clip a rect, add it to the damage list and return the clipped area
+    Rect markDamage(int x, int y, int width, int height);
+    
+    // Blend a pixel without bounds check or damage marking. For effects
+    // that already clipped and marked their area with markDamage().
+    void blendPixel(int x, int y, Color color);
+    
+    // Row y of the render target, for effects that read pixels back.
+    // Same contract as blendPixel(): callers clip and mark damage.
+    uint32_t* targetRow(int y) { return m_target + y * m_targetPitch; }
+    uint32_t targetPitch() const { return m_targetPitch; }
+    
     void clear(Color color);
     void drawPixel(int x, int y, Color color);
     void drawCircle(int cx, int cy, int radius, Color color);
@@ -26,20 +109,72 @@ public:
     void drawFilledRectangle(int x, int y, int width, int height, Color color);
     void drawRoundedRect(int x, int y, int width, int height, int radius, Color color);
     
+    // Span entry points: clipped and damage-marked once per row, blended
+    // with the division-free premultiplied path from pixel_ops.h
+    void fillRow(int x, int y, int width, Color color);
+    // Pixels are in the target layout, see pack()
+    void copyRow(int x, int y, int width, const uint32_t* pixels);
+    // Blend color into a row with its alpha scaled per pixel by coverage[i]
+    void blendRow(int x, int y, int width, Color color, const uint8_t* coverage);
+    
+    // Copy a surface, or part of it, to x, y. Rows are plain copies at
+    // alpha 255 and are mixed over the target at a constant alpha below.
+    void blit(const Surface& src, int x, int y, uint8_t alpha = 255);
+    void blitRect(const Surface& src, const Rect& srcRect, int x, int y, uint8_t alpha = 255);
+    
     void setAlpha(uint8_t alpha) { m_globalAlpha = alpha; }
+    void setBlendMode(BlendMode mode) { m_blendMode = mode; }
+    BlendMode blendMode() const { return m_blendMode; }
     
     uint32_t width() const { return m_width; }
     uint32_t height() const { return m_height; }
 
 private:
+    // Where a channel sits in a bitmask framebuffer pixel
+    struct ChannelLayout {
+        uint8_t shift;        // Lowest bit of the mask
+        uint8_t bits;         // Mask width, at most 8
+    };
+    
+    struct DisplayFormat {
+        bool swapRedBlue;     // Target pixels are 0x00BBGGRR
+        bool repack;          // Drawn as 0x00RRGGBB, repacked by present()
+        ChannelLayout red, green, blue;
+    };
+    
+    static DisplayFormat s_displayFormat;
+    
+    Renderer(uint32_t* fb, uint32_t width, uint32_t height, uint32_t pitch,
+             const DisplayFormat& format);
+    
     uint32_t* m_framebuffer;
+    uint32_t* m_backBuffer;
+    uint32_t* m_target;       // Back buffer if enabled, framebuffer otherwise
     uint32_t m_width;
     uint32_t m_height;
     uint32_t m_pitch;
+    uint32_t m_targetPitch;
     uint8_t m_globalAlpha;
+    BlendMode m_blendMode;
+    DisplayFormat m_format;
+    
+    Rect m_damage[MAX_DAMAGE_RECTS];
+    int m_damageCount;
+    int m_lastDamage;         // Most recently hit rect, checked first
+    
+    Rect m_clip;
+    Rect m_clipStack[MAX_CLIP_DEPTH];
+    int m_clipDepth;
+    int m_clipOverflow;       // Pushes past MAX_CLIP_DEPTH, popped first
+    
+    // Resolve blend mode and alpha once, then run draw(span) with the
+    // matching span pipeline (see renderer.cpp)
+    template <class Draw> void withSpan(Color color, const Draw& draw);
+    template <class Span> void fillSpan(int y, int x0, int x1, const Span& span);
     
-    uint32_t blend(uint32_t fg, uint32_t bg, uint8_t alpha);
-    int distanceSquared(int x1, int y1, int x2, int y2);
+    uint32_t repackPixel(uint32_t rgb) const;
+    uint32_t unpackPixel(uint32_t pixel) const;
+    void mergeCheapestDamagePair();
 };
 
 #endif // RENDERER_H
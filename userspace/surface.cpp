@@ -0,0 +1,22 @@
+#include "surface.h"
+#include "memory.h"
+
+Surface::Surface(uint32_t width, uint32_t height)
+    : m_pixels(nullptr), m_width(0), m_height(0), m_pitch(0) {
+    uint32_t pitch = (width + 3) & ~3u;
+    if (pitch == 0 || height == 0) return;
+    
+    m_pixels = new uint32_t[pitch * height];
+    if (!m_pixels) return;
+    
+    m_width = width;
+    m_height = height;
+    m_pitch = pitch;
+    for (uint32_t i = 0; i < pitch * height; i++) {
+        m_pixels[i] = 0;
+    }
+}
+
+Surface::~Surface() {
+    delete[] m_pixels;
+}
@@ -0,0 +1,36 @@
+#ifndef SURFACE_H
+#define SURFACE_H
+
+#include <stdint.h>
+
+// Owned off-screen pixel buffer. Pixels use the renderer's target layout,
+// so a Renderer constructed on a surface draws into it with every
+// primitive and Renderer::blit() composites it with plain row copies.
+class Surface {
+public:
+    Surface(uint32_t width, uint32_t height);
+    ~Surface();
+    
+    // False if the pixel allocation failed; the surface is then 0x0
+    bool valid() const { return m_pixels != nullptr; }
+    
+    uint32_t* pixels() { return m_pixels; }
+    const uint32_t* pixels() const { return m_pixels; }
+    uint32_t* row(int y) { return m_pixels + y * m_pitch; }
+    const uint32_t* row(int y) const { return m_pixels + y * m_pitch; }
+    
+    uint32_t width() const { return m_width; }
+    uint32_t height() const { return m_height; }
+    uint32_t pitch() const { return m_pitch; }
+    
+private:
+    uint32_t* m_pixels;
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_pitch;         // In pixels; rows start 16-byte aligned
+    
+    Surface(const Surface&) = delete;
+    Surface& operator=(const Surface&) = delete;
+};
+
+#endif // SURFACE_H